@@ -41,6 +41,17 @@ package genram_pkg is
   type t_ram16_type is array (integer range <>) of std_logic_vector(15 downto 0);
   type t_ram32_type is array (integer range <>) of std_logic_vector(31 downto 0);
 
+  -- Format of the g_init_file of the RAMs, see memory_loader_pkg:
+  -- MEMINIT_ASCII : one word per line in binary digits (mem_init_gen -f bram)
+  -- MEMINIT_BINARY: raw image, (width+7)/8 bytes per word, most significant
+  --                 byte first (mem_init_gen -f bin). Much faster to load in
+  --                 simulation, and only read there: synthesis stops with an
+  --                 error on it.
+  type t_meminit_format is (MEMINIT_ASCII, MEMINIT_BINARY);
+
+  -- Files named *.bin are MEMINIT_BINARY, all others MEMINIT_ASCII
+  function f_meminit_format (file_name : string) return t_meminit_format;
+
   -- Single-port synchronous RAM
   component generic_spram
     generic (
@@ -420,4 +431,14 @@ package body genram_pkg is
     end if;
   end f_check_bounds;
 
+  function f_meminit_format (file_name : string) return t_meminit_format is
+    constant c_suffix : string := ".bin";
+  begin
+    if file_name'length > c_suffix'length and
+      file_name(file_name'right-c_suffix'length+1 to file_name'right) = c_suffix then
+      return MEMINIT_BINARY;
+    end if;
+    return MEMINIT_ASCII;
+  end f_meminit_format;
+
 end genram_pkg;
@@ -36,6 +36,12 @@ package memory_loader_pkg is
 
   subtype t_meminit_array is t_generic_ram_init;
 
+  -- synthesis translate_off
+  -- Raw byte file for MEMINIT_BINARY init files (see genram_pkg).  Binary
+  -- init files are only read in simulation.
+  type t_meminit_char_file is file of character;
+  -- synthesis translate_on
+
   function f_empty_file_name (
     file_name : in string)
     return boolean;
@@ -45,6 +51,19 @@ package memory_loader_pkg is
     open_status      : in file_open_status;
     fail_if_notfound : in boolean);
 
+  -- synthesis translate_off
+  procedure f_read_bin_word (
+    file f_in : t_meminit_char_file;
+    word      : out std_logic_vector);
+
+  impure function f_load_bin_from_file
+    (file_name        : in string;
+     mem_size         : in integer;
+     mem_width        : in integer;
+     fail_if_notfound : boolean)
+    return t_meminit_array;
+  -- synthesis translate_on
+
   impure function f_load_mem_from_file
     (file_name : in string;
      mem_size  : in integer;
@@ -98,6 +117,62 @@ package body memory_loader_pkg is
     end if;
   end procedure f_file_open_check;
 
+  -- synthesis translate_off
+  -- Read one word of a MEMINIT_BINARY file, most significant byte first.
+  -- Missing bytes at the end of the file read as zero.
+  procedure f_read_bin_word (
+    file f_in : t_meminit_char_file;
+    word      : out std_logic_vector) is
+    constant c_width : integer := word'length;
+    variable c       : character;
+    variable byte    : integer;
+    variable tmp     : std_logic_vector(((c_width+7)/8)*8-1 downto 0);
+  begin
+    for k in (c_width+7)/8-1 downto 0 loop
+      if endfile(f_in) then
+        byte := 0;
+      else
+        read(f_in, c);
+        byte := character'pos(c);
+      end if;
+      tmp(k*8+7 downto k*8) := std_logic_vector(to_unsigned(byte, 8));
+    end loop;
+    word := tmp(c_width-1 downto 0);
+  end procedure f_read_bin_word;
+
+  -- Load a MEMINIT_BINARY file, as f_load_mem_from_file does for an ASCII
+  -- one.  A file that cannot be opened yields a zeroed memory.
+  impure function f_load_bin_from_file
+    (file_name        : in string;
+     mem_size         : in integer;
+     mem_width        : in integer;
+     fail_if_notfound : boolean)
+    return t_meminit_array is
+
+    FILE f_bin : t_meminit_char_file;
+    variable tmp_sv : std_logic_vector(mem_width-1 downto 0);
+    variable mem: t_meminit_array(0 to mem_size-1, mem_width-1 downto 0) := (others => (others => '0'));
+    variable status   : file_open_status;
+  begin
+    file_open(status, f_bin, file_name, read_mode);
+    f_file_open_check (file_name, status, fail_if_notfound);
+    if status /= OPEN_OK then
+      return mem;
+    end if;
+    for I in 0 to mem_size-1 loop
+      f_read_bin_word(f_bin, tmp_sv);
+      for J in 0 to mem_width-1 loop
+        mem(I, J) := tmp_sv(J);
+      end loop;
+    end loop;
+    if not endfile(f_bin) then
+      report "f_load_mem_from_file(): file '"&file_name&"' is bigger than available memory" severity FAILURE;
+    end if;
+    file_close(f_bin);
+    return mem;
+  end f_load_bin_from_file;
+  -- synthesis translate_on
+
   impure function f_load_mem_from_file
     (file_name        : in string;
      mem_size         : in integer;
@@ -116,6 +191,13 @@ package body memory_loader_pkg is
       return mem;
     end if;
 
+    if f_meminit_format(file_name) = MEMINIT_BINARY then
+      -- synthesis translate_off
+      return f_load_bin_from_file(file_name, mem_size, mem_width, fail_if_notfound);
+      -- synthesis translate_on
+      report "f_load_mem_from_file(): binary init file '"&file_name&"' can only be read in simulation" severity FAILURE;
+    end if;
+
     file_open(status, f_in, file_name, read_mode);
 
     f_file_open_check (file_name, status, fail_if_notfound);
@@ -157,11 +239,27 @@ package body memory_loader_pkg is
     variable tmp_bv : bit_vector(31 downto 0);
     variable mem: t_ram32_type(0 to mem_size-1) := (others => (others => '0'));
     variable status   : file_open_status;
+    -- synthesis translate_off
+    variable bin : t_meminit_array(0 to mem_size-1, 31 downto 0);
+    -- synthesis translate_on
   begin
     if f_empty_file_name(file_name) then
       return mem;
     end if;
 
+    if f_meminit_format(file_name) = MEMINIT_BINARY then
+      -- synthesis translate_off
+      bin := f_load_bin_from_file(file_name, mem_size, 32, fail_if_notfound);
+      for I in 0 to mem_size-1 loop
+        for J in 0 to 31 loop
+          mem(I)(J) := bin(I, J);
+        end loop;
+      end loop;
+      return mem;
+      -- synthesis translate_on
+      report "f_load_mem_from_file(): binary init file '"&file_name&"' can only be read in simulation" severity FAILURE;
+    end if;
+
     file_open(status, f_in, file_name, read_mode);
 
     f_file_open_check (file_name, status, fail_if_notfound);
@@ -198,11 +296,27 @@ package body memory_loader_pkg is
     variable tmp_bv : bit_vector(15 downto 0);
     variable mem: t_ram16_type(0 to mem_size-1) := (others => (others => '0'));
     variable status   : file_open_status;
+    -- synthesis translate_off
+    variable bin : t_meminit_array(0 to mem_size-1, 15 downto 0);
+    -- synthesis translate_on
   begin
     if f_empty_file_name(file_name) then
       return mem;
     end if;
 
+    if f_meminit_format(file_name) = MEMINIT_BINARY then
+      -- synthesis translate_off
+      bin := f_load_bin_from_file(file_name, mem_size, 16, fail_if_notfound);
+      for I in 0 to mem_size-1 loop
+        for J in 0 to 15 loop
+          mem(I)(J) := bin(I, J);
+        end loop;
+      end loop;
+      return mem;
+      -- synthesis translate_on
+      report "f_load_mem_from_file(): binary init file '"&file_name&"' can only be read in simulation" severity FAILURE;
+    end if;
+
     file_open(status, f_in, file_name, read_mode);
 
     f_file_open_check (file_name, status, fail_if_notfound);
@@ -239,11 +353,27 @@ package body memory_loader_pkg is
     variable tmp_bv : bit_vector(7 downto 0);
     variable mem: t_ram8_type(0 to mem_size-1) := (others => (others => '0'));
     variable status   : file_open_status;
+    -- synthesis translate_off
+    variable bin : t_meminit_array(0 to mem_size-1, 7 downto 0);
+    -- synthesis translate_on
   begin
     if f_empty_file_name(file_name) then
       return mem;
     end if;
 
+    if f_meminit_format(file_name) = MEMINIT_BINARY then
+      -- synthesis translate_off
+      bin := f_load_bin_from_file(file_name, mem_size, 8, fail_if_notfound);
+      for I in 0 to mem_size-1 loop
+        for J in 0 to 7 loop
+          mem(I)(J) := bin(I, J);
+        end loop;
+      end loop;
+      return mem;
+      -- synthesis translate_on
+      report "f_load_mem_from_file(): binary init file '"&file_name&"' can only be read in simulation" severity FAILURE;
+    end if;
+
     file_open(status, f_in, file_name, read_mode);
 
     f_file_open_check (file_name, status, fail_if_notfound);
@@ -283,11 +413,27 @@ package body memory_loader_pkg is
     variable tmp_bv : bit_vector(31 downto 0);
     variable mem: t_ram8_type(0 to mem_size-1) := (others => (others => '0'));
     variable status   : file_open_status;
+    -- synthesis translate_off
+    variable bin : t_meminit_array(0 to mem_size-1, 31 downto 0);
+    -- synthesis translate_on
   begin
     if f_empty_file_name(file_name) then
       return mem;
     end if;
 
+    if f_meminit_format(file_name) = MEMINIT_BINARY then
+      -- synthesis translate_off
+      bin := f_load_bin_from_file(file_name, mem_size, 32, fail_if_notfound);
+      for I in 0 to mem_size-1 loop
+        for J in 0 to 7 loop
+          mem(I)(J) := bin(I, byte_idx*8 + J);
+        end loop;
+      end loop;
+      return mem;
+      -- synthesis translate_on
+      report "f_load_mem_from_file(): binary init file '"&file_name&"' can only be read in simulation" severity FAILURE;
+    end if;
+
     file_open(status, f_in, file_name, read_mode);
 
     f_file_open_check (file_name, status, fail_if_notfound);
@@ -4,6 +4,11 @@
 -- 0x08 = read stride
 -- 0x0C = write stride
 -- 0x10 = transfer count
+-- 0x14 = descriptor address (write to start descriptor mode, when idle)
+-- 0x18 = descriptor control/status
+--          read:  bit 0 = running, bit 1 = descriptor read error,
+--                 bit 2 = stop requested
+--          write: bit 0 = stop after the current descriptor
 --
 -- Behaviour:
 --   While (transfer count > 0) {
@@ -20,6 +25,33 @@
 -- Status information:
 --   All registers can be inspected during the transfer
 --   Interrupt line is raised upon completion
+--
+-- Descriptor mode:
+--   Writing the address of a descriptor to 0x14 makes the DMA fetch it
+--   through the read master, copy as above, write the status back through
+--   the write master and go on with the next one, without the CPU.
+--   Descriptors are 8 words, 32 byte aligned:
+--     +0x00 flags/status      +0x10 write stride
+--     +0x04 read address      +0x14 transfer count
+--     +0x08 write address     +0x18 next descriptor address
+--     +0x0C read stride       +0x1C unused
+--   The flags are read first: a descriptor found valid has been written
+--   completely before, as long as the CPU sets valid last.
+--   Flags: bit 0 = valid (owned by the DMA), bit 1 = interrupt when done,
+--          bit 2 = last (stop after this one).
+--   The status written back is the flags with valid cleared, bit 31 (done)
+--   set and bit 30 set if a read or write got ERR/RTY.
+--
+--   The chain stops at a descriptor without the valid bit, after a last
+--   one, or on request (0x18), and 0x14 then holds the address of the
+--   next descriptor.  To stream, the CPU makes a ring of descriptors,
+--   gives them back by setting valid again and writes 0x14 after that.
+--   While running, that write does not change 0x14 but makes the DMA
+--   read again a descriptor it found not valid, and go on after a last
+--   one, so that no descriptor given back is missed.  The interrupt line
+--   is only raised for descriptors with the interrupt flag.  The
+--   registers 0x00 to 0x10 show the current descriptor and must not be
+--   written while running.
 
 library ieee;
 use ieee.std_logic_1164.all;
@@ -74,6 +106,29 @@ architecture rtl of xwb_dma is
   signal write_stride        : t_wishbone_address;
   signal transfer_count      : t_wishbone_address;
   -- result status: fail/ok ?
+
+  -- Descriptor mode
+  type t_desc_state is (DESC_IDLE, DESC_FETCH, DESC_COPY, DESC_STATUS);
+  constant c_desc_words : natural := 7; -- fetched, without the unused word
+  constant c_desc_valid : natural := 0;
+  constant c_desc_irq   : natural := 1;
+  constant c_desc_last  : natural := 2;
+  constant c_desc_err   : natural := 30;
+  constant c_desc_done  : natural := 31;
+
+  signal desc_state     : t_desc_state;
+  signal desc_address   : t_wishbone_address; -- current descriptor
+  signal desc_src       : t_wishbone_address;
+  signal desc_count     : t_wishbone_address;
+  signal desc_flags     : t_wishbone_data;
+  signal desc_next      : t_wishbone_address;
+  signal desc_issue     : unsigned(2 downto 0);
+  signal desc_result    : unsigned(2 downto 0);
+  signal desc_fetch_err : std_logic; -- a descriptor read failed
+  signal desc_copy_err  : std_logic; -- the copy got ERR/RTY
+  signal desc_kick      : std_logic; -- 0x14 written while running
+  signal desc_stop      : std_logic;
+  signal ring_q         : t_wishbone_data;
   
   -- Registered wishbone control signals
   signal r_master_o_CYC : std_logic;
@@ -99,6 +154,13 @@ architecture rtl of xwb_dma is
   signal ring_full     : boolean;
   signal ring_empty    : boolean;
   signal done_transfer : boolean;
+
+  signal desc_issue_progress  : boolean;
+  signal desc_result_progress : boolean;
+  signal new_desc_issue       : unsigned(2 downto 0);
+  signal new_desc_result      : unsigned(2 downto 0);
+  signal desc_copy_done       : boolean;
+  signal doorbell             : boolean;
   
   function active_high(x : boolean)
     return std_logic is
@@ -145,12 +207,19 @@ begin
   r_master_o.WE  <= '0';
   w_master_o.WE  <= '1';
   r_master_o.DAT <= (others => '0');
+  w_master_o.DAT <= desc_flags when desc_state = DESC_STATUS else ring_q;
+  
+  -- Detect bus progress (the masters are lent to the descriptor logic in
+  -- DESC_FETCH and DESC_STATUS)
+  read_issue_progress   <= desc_state /= DESC_FETCH and r_master_o_STB = '1' and r_master_i.STALL = '0';
+  write_issue_progress  <= desc_state /= DESC_STATUS and w_master_o_STB = '1' and w_master_i.STALL = '0';
+  read_result_progress  <= desc_state /= DESC_FETCH and r_master_o_CYC = '1' and (r_master_i.ACK = '1' or r_master_i.ERR = '1' or r_master_i.RTY = '1');
+  write_result_progress <= desc_state /= DESC_STATUS and w_master_o_CYC = '1' and (w_master_i.ACK = '1' or w_master_i.ERR = '1' or w_master_i.RTY = '1');
   
-  -- Detect bus progress
-  read_issue_progress   <= r_master_o_STB = '1' and r_master_i.STALL = '0';
-  write_issue_progress  <= w_master_o_STB = '1' and w_master_i.STALL = '0';
-  read_result_progress  <= r_master_o_CYC = '1' and (r_master_i.ACK = '1' or r_master_i.ERR = '1' or r_master_i.RTY = '1');
-  write_result_progress <= w_master_o_CYC = '1' and (w_master_i.ACK = '1' or w_master_i.ERR = '1' or w_master_i.RTY = '1');
+  desc_issue_progress   <= desc_state = DESC_FETCH and r_master_o_STB = '1' and r_master_i.STALL = '0';
+  desc_result_progress  <= desc_state = DESC_FETCH and r_master_o_CYC = '1' and (r_master_i.ACK = '1' or r_master_i.ERR = '1' or r_master_i.RTY = '1');
+  new_desc_issue        <= (desc_issue  + 1) when desc_issue_progress  else desc_issue;
+  new_desc_result       <= (desc_result + 1) when desc_result_progress else desc_result;
   
   -- Advance read pointers
   new_read_issue_offset   <= (read_issue_offset   + 1) when read_issue_progress   else read_issue_offset;
@@ -172,6 +241,13 @@ begin
   done_transfer <= unsigned(transfer_count(c_wishbone_address_width-1 downto 1)) = 0 
                    and (read_issue_progress or transfer_count(0) = '0');
   
+  -- 0x14 written while running counts in the same cycle
+  doorbell <= slave_i.CYC = '1' and slave_i.STB = '1' and slave_i.WE = '1'
+              and unsigned(slave_i.ADR(4 downto 2)) = 5;
+  
+  -- Every read issued has been written
+  desc_copy_done <= unsigned(transfer_count) = 0 and read_issue_offset = write_result_offset;
+  
   ring : generic_simple_dpram
     generic map(
       g_data_width => 32,
@@ -185,7 +261,7 @@ begin
       da_i    => r_master_i.DAT,
       clkb_i  => clk_i,
       ab_i    => index(new_write_issue_offset),
-      qb_o    => w_master_o.DAT);
+      qb_o    => ring_q);
   
   main : process(clk_i)
   begin
@@ -209,6 +285,15 @@ begin
         slave_o_ACK <= '0';
         slave_o_DAT <= (others => '0');
         interrupt_o <= '0';
+        
+        desc_state     <= DESC_IDLE;
+        desc_address   <= (others => '0');
+        desc_issue     <= (others => '0');
+        desc_result    <= (others => '0');
+        desc_fetch_err <= '0';
+        desc_copy_err  <= '0';
+        desc_kick      <= '0';
+        desc_stop      <= '0';
       else
         -- Output any read the user requests
         case to_integer(unsigned(slave_i.ADR(4 downto 2))) is
@@ -217,6 +302,11 @@ begin
           when 2 => slave_o_DAT <= read_stride;
           when 3 => slave_o_DAT <= write_stride;
           when 4 => slave_o_DAT <= transfer_count;
+          when 5 => slave_o_DAT <= desc_address;
+          when 6 => slave_o_DAT <= (0 => active_high(desc_state /= DESC_IDLE),
+                                    1 => desc_fetch_err,
+                                    2 => desc_stop,
+                                    others => '0');
           when others => slave_o_DAT <= (others => '0');
         end case;
         
@@ -233,7 +323,8 @@ begin
                                       (new_read_result_offset  /= new_read_issue_offset));
         w_master_o_STB <= active_high (new_write_issue_offset  /= read_result_offset); -- avoid read during write
         w_master_o_CYC <= active_high (new_write_result_offset /= read_result_offset);
-        interrupt_o    <= active_high (write_result_progress and done_transfer and ring_empty);
+        interrupt_o    <= active_high (write_result_progress and done_transfer and ring_empty
+                                       and desc_state = DESC_IDLE);
         
         transfer_count      <= new_transfer_count;
         read_issue_offset   <= new_read_issue_offset;
@@ -241,6 +332,102 @@ begin
         write_issue_offset  <= new_write_issue_offset;
         write_result_offset <= new_write_result_offset;
         
+        -- Descriptor logic, overrides the above
+        desc_issue  <= new_desc_issue;
+        desc_result <= new_desc_result;
+        case desc_state is
+          when DESC_IDLE =>
+            null;
+            
+          when DESC_FETCH =>
+            -- read_issue_address walks the descriptor
+            if desc_issue_progress then
+              read_issue_address <= std_logic_vector(unsigned(read_issue_address) + 4);
+            end if;
+            r_master_o_STB <= active_high(new_desc_issue  /= c_desc_words);
+            r_master_o_CYC <= active_high(new_desc_result /= c_desc_words);
+            
+            if desc_result_progress then
+              if r_master_i.ACK = '0' then
+                desc_fetch_err <= '1';
+              end if;
+              case to_integer(desc_result) is
+                when 0 => desc_flags          <= r_master_i.DAT;
+                when 1 => desc_src            <= r_master_i.DAT;
+                when 2 => write_issue_address <= r_master_i.DAT;
+                when 3 => read_stride         <= r_master_i.DAT;
+                when 4 => write_stride        <= r_master_i.DAT;
+                when 5 => desc_count          <= r_master_i.DAT;
+                when others => desc_next      <= r_master_i.DAT;
+              end case;
+              
+              if new_desc_result = c_desc_words then
+                if desc_fetch_err = '1' or r_master_i.ACK = '0' then
+                  desc_state <= DESC_IDLE;
+                elsif desc_flags(c_desc_valid) = '1' then
+                  read_issue_address <= desc_src;
+                  transfer_count     <= desc_count;
+                  desc_copy_err      <= '0';
+                  desc_state         <= DESC_COPY;
+                elsif desc_kick = '1' or doorbell then
+                  -- Given back while it was read, read it again
+                  read_issue_address <= desc_address;
+                  desc_issue         <= (others => '0');
+                  desc_result        <= (others => '0');
+                  desc_kick          <= '0';
+                  r_master_o_STB     <= '1';
+                  r_master_o_CYC     <= '1';
+                else
+                  desc_state <= DESC_IDLE;
+                end if;
+              end if;
+            end if;
+            
+          when DESC_COPY =>
+            if (read_result_progress  and r_master_i.ACK = '0') or
+               (write_result_progress and w_master_i.ACK = '0') then
+              desc_copy_err <= '1';
+            end if;
+            
+            if desc_copy_done then
+              write_issue_address <= desc_address;
+              desc_flags(c_desc_valid) <= '0';
+              desc_flags(c_desc_err)   <= desc_copy_err;
+              desc_flags(c_desc_done)  <= '1';
+              w_master_o_STB <= '1';
+              w_master_o_CYC <= '1';
+              desc_state     <= DESC_STATUS;
+            end if;
+            
+          when DESC_STATUS =>
+            -- Single write of the status word
+            if w_master_i.STALL = '0' then
+              w_master_o_STB <= '0';
+            else
+              w_master_o_STB <= w_master_o_STB;
+            end if;
+            w_master_o_CYC <= '1';
+            
+            if w_master_o_CYC = '1' and (w_master_i.ACK = '1' or w_master_i.ERR = '1' or w_master_i.RTY = '1') then
+              w_master_o_STB <= '0';
+              w_master_o_CYC <= '0';
+              interrupt_o    <= desc_flags(c_desc_irq);
+              desc_address   <= desc_next;
+              if desc_stop = '1' or
+                 (desc_flags(c_desc_last) = '1' and desc_kick = '0' and not doorbell) then
+                desc_state <= DESC_IDLE;
+              else
+                read_issue_address <= desc_next;
+                desc_issue         <= (others => '0');
+                desc_result        <= (others => '0');
+                desc_kick          <= '0';
+                r_master_o_STB     <= '1';
+                r_master_o_CYC     <= '1';
+                desc_state         <= DESC_FETCH;
+              end if;
+            end if;
+        end case;
+        
         -- Control logic
         if (slave_i.CYC = '1' and slave_i.STB = '1' and slave_i.WE = '1') then
           case to_integer(unsigned(slave_i.ADR(4 downto 2))) is
@@ -249,6 +436,26 @@ begin
             when 2 => update(read_stride);
             when 3 => update(write_stride);
             when 4 => update(transfer_count);
+            when 5 =>
+              if desc_state /= DESC_IDLE then
+                desc_kick <= '1';
+              elsif desc_copy_done then
+                -- Start descriptor mode
+                desc_address       <= slave_i.DAT;
+                read_issue_address <= slave_i.DAT;
+                desc_issue         <= (others => '0');
+                desc_result        <= (others => '0');
+                desc_fetch_err     <= '0';
+                desc_kick          <= '0';
+                desc_stop          <= '0';
+                r_master_o_STB     <= '1';
+                r_master_o_CYC     <= '1';
+                desc_state         <= DESC_FETCH;
+              end if;
+            when 6 =>
+              if slave_i.DAT(0) = '1' and desc_state /= DESC_IDLE then
+                desc_stop <= '1';
+              end if;
             when others => null;
           end case;
         end if;
@@ -6,14 +6,23 @@
 
 library ieee;
 use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
 
 use work.wishbone_pkg.all;
+use work.gencores_pkg.all;
 
 entity xwb_i2c_master is
   generic(
-    g_interface_mode      : t_wishbone_interface_mode      := CLASSIC;
-    g_address_granularity : t_wishbone_address_granularity := WORD;
-    g_num_interfaces      : integer := 1);
+    g_interface_mode         : t_wishbone_interface_mode      := CLASSIC;
+    g_address_granularity    : t_wishbone_address_granularity := WORD;
+    g_num_interfaces         : integer := 1;
+    -- When false, the interfaces share one I2C master core and are selected
+    -- through its interface register, so only one can be used at a time.
+    -- When true, every interface has its own I2C master core and its own
+    -- set of registers (8 registers per interface, one after the other), so
+    -- that all the interfaces can transfer at the same time. The interrupt
+    -- is the OR of the interrupts of all the cores. At most 8 interfaces.
+    g_independent_interfaces : boolean := false);
   port (
     clk_sys_i : in std_logic;
     rst_n_i   : in std_logic;
@@ -37,6 +46,7 @@ architecture rtl of xwb_i2c_master is
 
 begin  -- rtl
 
+  gen_shared : if not g_independent_interfaces generate
 
   U_Wrapped_I2C : wb_i2c_master
     generic map (
@@ -62,7 +72,98 @@ begin  -- rtl
       sda_pad_i    => sda_pad_i,
       sda_pad_o    => sda_pad_o,
       sda_padoen_o => sda_padoen_o);
-  
+
+  end generate gen_shared;
+
+  gen_independent : if g_independent_interfaces generate
+
+    -- first address bit above the 8 registers of one core
+    function f_sel_lsb return integer is
+    begin
+      if g_address_granularity = BYTE then
+        return 5;
+      else
+        return 3;
+      end if;
+    end function f_sel_lsb;
+
+    constant c_sel_lsb  : integer := f_sel_lsb;
+    constant c_sel_bits : integer := f_log2_ceil(g_num_interfaces);
+
+    type t_dat_array is array (natural range <>) of std_logic_vector(31 downto 0);
+
+    signal sel       : integer range 0 to 2**c_sel_bits-1;
+    signal stb       : std_logic_vector(g_num_interfaces-1 downto 0);
+    signal ack       : std_logic_vector(g_num_interfaces-1 downto 0);
+    signal stall     : std_logic_vector(g_num_interfaces-1 downto 0);
+    signal irq       : std_logic_vector(g_num_interfaces-1 downto 0);
+    signal dat       : t_dat_array(0 to g_num_interfaces-1);
+    signal dat_or    : t_dat_array(0 to g_num_interfaces);
+    signal ack_unmap : std_logic;
+
+  begin
+
+    assert g_num_interfaces <= 8
+      report "xwb_i2c_master: at most 8 independent interfaces"
+      severity failure;
+
+    sel <= to_integer(unsigned(slave_i.adr(c_sel_lsb + c_sel_bits - 1 downto c_sel_lsb)));
+
+    gen_cores : for i in 0 to g_num_interfaces-1 generate
+      stb(i) <= slave_i.stb when sel = i else '0';
+
+      U_Wrapped_I2C : wb_i2c_master
+        generic map (
+          g_interface_mode      => g_interface_mode,
+          g_address_granularity => g_address_granularity,
+          g_num_interfaces      => 1)
+        port map (
+          clk_sys_i       => clk_sys_i,
+          rst_n_i         => rst_n_i,
+          wb_adr_i        => slave_i.adr(4 downto 0),
+          wb_dat_i        => slave_i.dat,
+          wb_dat_o        => dat(i),
+          wb_sel_i        => slave_i.sel,
+          wb_stb_i        => stb(i),
+          wb_cyc_i        => slave_i.cyc,
+          wb_we_i         => slave_i.we,
+          wb_ack_o        => ack(i),
+          wb_stall_o      => stall(i),
+          int_o           => irq(i),
+          scl_pad_i       => scl_pad_i(i downto i),
+          scl_pad_o       => scl_pad_o(i downto i),
+          scl_padoen_o    => scl_padoen_o(i downto i),
+          sda_pad_i       => sda_pad_i(i downto i),
+          sda_pad_o       => sda_pad_o(i downto i),
+          sda_padoen_o    => sda_padoen_o(i downto i));
+
+      -- only the core that acks drives the data bus
+      dat_or(i+1) <= dat_or(i) or (dat(i) and (31 downto 0 => ack(i)));
+    end generate gen_cores;
+
+    dat_or(0) <= (others => '0');
+
+    -- ack accesses to the windows without a core, so the bus does not hang
+    p_unmapped : process (clk_sys_i)
+    begin
+      if rising_edge(clk_sys_i) then
+        if rst_n_i = '0' then
+          ack_unmap <= '0';
+        elsif sel >= g_num_interfaces and slave_i.cyc = '1' and slave_i.stb = '1' then
+          ack_unmap <= not ack_unmap or f_to_std_logic(g_interface_mode = PIPELINED);
+        else
+          ack_unmap <= '0';
+        end if;
+      end if;
+    end process p_unmapped;
+
+    slave_o.ack   <= f_reduce_or(ack) or ack_unmap;
+    slave_o.stall <= stall(sel) when sel < g_num_interfaces else '0';
+    slave_o.dat   <= dat_or(g_num_interfaces);
+    int_o         <= f_reduce_or(irq);
+
+  end generate gen_independent;
+
   slave_o.err <= '0';
   slave_o.rty <= '0';
 end rtl;
@@ -1,6 +1,15 @@
--- Do not edit.  Generated on Mon Apr 20 10:08:30 2020 by gingold
--- With Cheby 1.4.dev0 and these options:
---  -i wb_indirect_regs.cheby --gen-hdl=wb_indirect_regs.vhd
+-- Maintained by hand, not generated.
+--
+-- It started as the output of Cheby 1.4.dev0 (2020) for the first version
+-- of wb_indirect_regs.cheby, with only addr and data, run as:
+--   cheby -i wb_indirect_regs.cheby --gen-hdl=wb_indirect_regs.vhd
+-- The ctrl register and the window submap were then added by hand to match
+-- the current wb_indirect_regs.cheby, following the code Cheby 1.4 emits
+-- for a register with write-strobe and for a busgroup submap.  This file
+-- has not been compared with Cheby's output for the current .cheby.  To
+-- go back to a generated file, run the command above with Cheby 1.4.dev0
+-- or later and diff the result: the ports, the reset values and the
+-- address decode must match this file before it is replaced.
 
 
 library ieee;
@@ -26,12 +35,23 @@ entity wb_indirect_regs is
     data_wr_o            : out   std_logic;
     data_rd_o            : out   std_logic;
     data_wack_i          : in    std_logic;
-    data_rack_i          : in    std_logic
+    data_rack_i          : in    std_logic;
+
+    -- control
+    -- add 4 to addr after each data access
+    ctrl_autoinc_o       : out   std_logic;
+    -- with autoinc, read the next word ahead after a read
+    ctrl_prefetch_o      : out   std_logic;
+    ctrl_wr_o            : out   std_logic;
+
+    -- data window, every word is an alias of data
+    window_i             : in    t_wishbone_master_in;
+    window_o             : out   t_wishbone_master_out
   );
 end wb_indirect_regs;
 
 architecture syn of wb_indirect_regs is
-  signal adr_int                        : std_logic_vector(2 downto 2);
+  signal adr_int                        : std_logic_vector(6 downto 2);
   signal rd_req_int                     : std_logic;
   signal wr_req_int                     : std_logic;
   signal rd_ack_int                     : std_logic;
@@ -42,16 +62,27 @@ architecture syn of wb_indirect_regs is
   signal wb_wip                         : std_logic;
   signal addr_wreq                      : std_logic;
   signal data_wreq                      : std_logic;
+  signal ctrl_autoinc_reg               : std_logic;
+  signal ctrl_prefetch_reg              : std_logic;
+  signal ctrl_wreq                      : std_logic;
+  signal ctrl_wack                      : std_logic;
+  signal window_re                      : std_logic;
+  signal window_we                      : std_logic;
+  signal window_wt                      : std_logic;
+  signal window_rt                      : std_logic;
+  signal window_tr                      : std_logic;
+  signal window_wack                    : std_logic;
+  signal window_rack                    : std_logic;
   signal rd_ack_d0                      : std_logic;
   signal rd_dat_d0                      : std_logic_vector(31 downto 0);
   signal wr_req_d0                      : std_logic;
-  signal wr_adr_d0                      : std_logic_vector(2 downto 2);
+  signal wr_adr_d0                      : std_logic_vector(6 downto 2);
   signal wr_dat_d0                      : std_logic_vector(31 downto 0);
   signal wr_sel_d0                      : std_logic_vector(3 downto 0);
 begin
 
   -- WB decode signals
-  adr_int <= wb_i.adr(2 downto 2);
+  adr_int <= wb_i.adr(6 downto 2);
   wb_en <= wb_i.cyc and wb_i.stb;
 
   process (clk_i) begin
@@ -107,39 +138,113 @@ begin
   data_o <= wr_dat_d0;
   data_wr_o <= data_wreq;
 
+  -- Register ctrl
+  ctrl_autoinc_o <= ctrl_autoinc_reg;
+  ctrl_prefetch_o <= ctrl_prefetch_reg;
+  process (clk_i) begin
+    if rising_edge(clk_i) then
+      if rst_n_i = '0' then
+        ctrl_autoinc_reg <= '1';
+        ctrl_prefetch_reg <= '0';
+        ctrl_wack <= '0';
+      else
+        if ctrl_wreq = '1' then
+          ctrl_autoinc_reg <= wr_dat_d0(0);
+          ctrl_prefetch_reg <= wr_dat_d0(1);
+        end if;
+        ctrl_wack <= ctrl_wreq;
+      end if;
+    end if;
+  end process;
+  ctrl_wr_o <= ctrl_wack;
+
+  -- Interface window
+  window_tr <= window_wt or window_rt;
+  process (clk_i) begin
+    if rising_edge(clk_i) then
+      if rst_n_i = '0' then
+        window_rt <= '0';
+        window_wt <= '0';
+      else
+        window_rt <= (window_rt or window_re) and not window_rack;
+        window_wt <= (window_wt or window_we) and not window_wack;
+      end if;
+    end if;
+  end process;
+  window_o.cyc <= window_tr;
+  window_o.stb <= window_tr;
+  window_wack <= window_i.ack and window_wt;
+  window_rack <= window_i.ack and window_rt;
+  window_o.adr <= ((25 downto 0 => '0') & adr_int(5 downto 2)) & (1 downto 0 => '0');
+  window_o.sel <= (others => '1');
+  window_o.we <= window_wt;
+  window_o.dat <= wr_dat_d0;
+
   -- Process for write requests.
-  process (wr_adr_d0, wr_req_d0, data_wack_i) begin
+  process (wr_adr_d0, wr_req_d0, data_wack_i, ctrl_wack, window_wack) begin
     addr_wreq <= '0';
     data_wreq <= '0';
-    case wr_adr_d0(2 downto 2) is
-    when "0" => 
-      -- Reg addr
-      addr_wreq <= wr_req_d0;
-      wr_ack_int <= wr_req_d0;
-    when "1" => 
-      -- Reg data
-      data_wreq <= wr_req_d0;
-      wr_ack_int <= data_wack_i;
+    ctrl_wreq <= '0';
+    window_we <= '0';
+    case wr_adr_d0(6 downto 6) is
+    when "0" =>
+      case wr_adr_d0(5 downto 2) is
+      when "0000" =>
+        -- Reg addr
+        addr_wreq <= wr_req_d0;
+        wr_ack_int <= wr_req_d0;
+      when "0001" =>
+        -- Reg data
+        data_wreq <= wr_req_d0;
+        wr_ack_int <= data_wack_i;
+      when "0010" =>
+        -- Reg ctrl
+        ctrl_wreq <= wr_req_d0;
+        wr_ack_int <= ctrl_wack;
+      when others =>
+        wr_ack_int <= wr_req_d0;
+      end case;
+    when "1" =>
+      -- Submap window
+      window_we <= wr_req_d0;
+      wr_ack_int <= window_wack;
     when others =>
       wr_ack_int <= wr_req_d0;
     end case;
   end process;
 
   -- Process for read requests.
-  process (adr_int, rd_req_int, addr_i, data_rack_i, data_i) begin
+  process (adr_int, rd_req_int, addr_i, data_rack_i, data_i, ctrl_autoinc_reg, ctrl_prefetch_reg, window_i.dat, window_rack) begin
     -- By default ack read requests
     rd_dat_d0 <= (others => 'X');
     data_rd_o <= '0';
-    case adr_int(2 downto 2) is
-    when "0" => 
-      -- Reg addr
-      rd_ack_d0 <= rd_req_int;
-      rd_dat_d0 <= addr_i;
-    when "1" => 
-      -- Reg data
-      data_rd_o <= rd_req_int;
-      rd_ack_d0 <= data_rack_i;
-      rd_dat_d0 <= data_i;
+    window_re <= '0';
+    case adr_int(6 downto 6) is
+    when "0" =>
+      case adr_int(5 downto 2) is
+      when "0000" =>
+        -- Reg addr
+        rd_ack_d0 <= rd_req_int;
+        rd_dat_d0 <= addr_i;
+      when "0001" =>
+        -- Reg data
+        data_rd_o <= rd_req_int;
+        rd_ack_d0 <= data_rack_i;
+        rd_dat_d0 <= data_i;
+      when "0010" =>
+        -- Reg ctrl
+        rd_ack_d0 <= rd_req_int;
+        rd_dat_d0(0) <= ctrl_autoinc_reg;
+        rd_dat_d0(1) <= ctrl_prefetch_reg;
+        rd_dat_d0(31 downto 2) <= (others => '0');
+      when others =>
+        rd_ack_d0 <= rd_req_int;
+      end case;
+    when "1" =>
+      -- Submap window
+      window_re <= rd_req_int;
+      rd_dat_d0 <= window_i.dat;
+      rd_ack_d0 <= window_rack;
     when others =>
       rd_ack_d0 <= rd_req_int;
     end case;
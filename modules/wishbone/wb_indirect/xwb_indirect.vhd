@@ -7,10 +7,20 @@
 -- unit name:   xwb_indirect
 --
 -- description: This design is a wishbone slave that drivers a wishbone master.
---   As a slave, it has 2 registers: address and data.  An access to the data
---   register starts a transaction on the WB master side using the address of
---   the address register.  At the end of the transaction, the address
---   register is incremented by 4.
+--   As a slave, it has an address register, a data register and a control
+--   register.  An access to the data register starts a transaction on the WB
+--   master side using the address of the address register.  At the end of
+--   the transaction, the address register is incremented by 4 (unless
+--   ctrl.autoinc is cleared, eg to read a FIFO).
+--
+--   The 16 words at 0x40-0x7f are all aliases of the data register, so that
+--   a host can copy a block with consecutive addresses (which bridges turn
+--   into bursts) after a single write to the address register.
+--
+--   Writes are posted: the slave write is acked as soon as the master
+--   transaction starts.  With ctrl.prefetch (and autoinc), the word after
+--   the one read is read in advance, so that the next data read doesn't
+--   wait for the master bus.  Prefetched data is dropped on any write.
 --
 --------------------------------------------------------------------------------
 -- Copyright CERN 2020
@@ -58,50 +68,157 @@ architecture arch of xwb_indirect is
   signal data_rd_out  : std_logic;
   signal data_wack_in : std_logic;
   signal data_rack_in : std_logic;
+  signal autoinc      : std_logic;
+  signal prefetch     : std_logic;
+  signal ctrl_wr_out  : std_logic;
+  signal window_in    : t_wishbone_master_in;
+  signal window_out   : t_wishbone_master_out;
+
+  --  The window access being served (the window keeps cyc until ack).
+  signal win_busy     : std_logic;
+  signal win_ack      : std_logic;
 
   type t_state is (IDLE, READ, WRITE);
   signal state : t_state;
 
+  signal cyc : std_logic;
   signal stb : std_logic;
-  signal we : std_logic;
+  signal we  : std_logic;
+  signal m_adr : std_logic_vector(31 downto 0);
+  signal m_dat : std_logic_vector(31 downto 0);
+
+  --  Slave accesses waiting for the master bus, and whether the window
+  --  (rather than the data register) has to be acked.
+  signal rd_pend  : std_logic;
+  signal wr_pend  : std_logic;
+  signal wr_dat   : std_logic_vector(31 downto 0);
+  signal ack_win  : std_logic;
+
+  --  Prefetch: pf_dat is the word at addr.  pf_drop discards the read
+  --  in progress, pf_armed is set after a read with prefetch enabled.
+  signal pf_valid : std_logic;
+  signal pf_drop  : std_logic;
+  signal pf_armed : std_logic;
+  signal pf_dat   : std_logic_vector(31 downto 0);
 begin
   process (clk_i)
+    --  Slave request this cycle (data register or window).
+    variable rd, wr, win : std_logic;
+    --  Ack this cycle, to the data register or to the window.
+    variable ack_rd, ack_wr, ack_to_win : std_logic;
+    --  Set when the word being read can't be kept as the prefetch.
+    variable drop : std_logic;
+    --  A slave read waits for the master bus (including this cycle's).
+    variable rd_wait : std_logic;
+    variable next_addr : std_logic_vector(31 downto 0);
   begin
     if rising_edge (clk_i) then
       if rst_n_i = '0' then
         state <= IDLE;
         data_wack_in <= '0';
         data_rack_in <= '0';
+        win_ack <= '0';
+        win_busy <= '0';
         data <= (others => '0');
         addr <= (others => '0');
+        cyc <= '0';
         stb <= '0';
         we <= '0';
+        rd_pend <= '0';
+        wr_pend <= '0';
+        ack_win <= '0';
+        pf_valid <= '0';
+        pf_drop <= '0';
+        pf_armed <= '0';
       else
         data_wack_in <= '0';
         data_rack_in <= '0';
+        win_ack <= '0';
+        ack_rd := '0';
+        ack_wr := '0';
+        ack_to_win := ack_win;
+        drop := pf_drop;
+        rd_wait := rd_pend;
 
-        --  Write to the address register.
+        if autoinc = '1' then
+          next_addr := std_logic_vector(unsigned(addr) + 4);
+        else
+          next_addr := addr;
+        end if;
+
+        --  Slave requests.  There is at most one at a time, as the
+        --  registers wait for the ack.
+        rd := data_rd_out;
+        wr := data_wr_out;
+        win := '0';
+        if window_out.cyc = '0' then
+          win_busy <= '0';
+        elsif win_busy = '0' then
+          win_busy <= '1';
+          rd := not window_out.we;
+          wr := window_out.we;
+          win := '1';
+        end if;
+        if (rd or wr) = '1' then
+          ack_win <= win;
+          ack_to_win := win;
+        end if;
+
+        --  The prefetched word is only valid until addr, ctrl or the
+        --  memory is written.
+        if addr_wr_out = '1' or ctrl_wr_out = '1' or wr = '1' then
+          pf_valid <= '0';
+          pf_armed <= '0';
+          drop := '1';
+        end if;
         if addr_wr_out = '1' then
           addr <= addr_out;
         end if;
 
+        if wr = '1' then
+          wr_pend <= '1';
+          wr_dat <= data_out;
+        elsif rd = '1' then
+          if pf_valid = '1' then
+            --  Served from the prefetch.
+            pf_valid <= '0';
+            data <= pf_dat;
+            addr <= next_addr;
+            ack_rd := '1';
+          else
+            rd_pend <= '1';
+            rd_wait := '1';
+          end if;
+        end if;
+
         case state is
           when IDLE =>
-            if data_wr_out = '1' then
-              we <= '1';
+            if wr_pend = '1' then
+              --  Posted write: ack it now.
+              cyc <= '1';
               stb <= '1';
-              --  Capture the data.
-              data <= data_out;
-              state <= WRITE;
-            elsif data_rd_out = '1' then
               we <= '1';
+              m_adr <= addr;
+              m_dat <= wr_dat;
+              wr_pend <= '0';
+              addr <= next_addr;
+              ack_wr := '1';
+              state <= WRITE;
+            elsif rd_wait = '1' or (pf_armed = '1' and pf_valid = '0') then
+              cyc <= '1';
               stb <= '1';
+              we <= '0';
+              m_adr <= addr;
+              drop := '0';
+              if addr_wr_out = '1' or ctrl_wr_out = '1' or wr = '1' then
+                drop := '1';
+              end if;
               state <= READ;
             end if;
           when WRITE
             | READ =>
-            if mode = PIPELINED then
-              --  STB is asserted for one cycle in piplined mode.
+            if mode = PIPELINED and master_wb_i.stall = '0' then
+              --  STB is asserted until accepted in pipelined mode.
               stb <= '0';
             end if;
 
@@ -109,45 +226,73 @@ begin
               or master_wb_i.err = '1'
               or master_wb_i.rty = '1'
             then
-              --  End of transaction (for classic mode).
+              --  End of transaction.
+              cyc <= '0';
               stb <= '0';
-
-              --  Ack the master.
-              if state = WRITE then
-                data_wack_in <= '1';
-              else
-                --  Capture the data.
-                data <= master_wb_i.dat;
-                data_rack_in <= '1';
+              if state = READ and drop = '0' then
+                if rd_wait = '1' then
+                  rd_pend <= '0';
+                  data <= master_wb_i.dat;
+                  addr <= next_addr;
+                  ack_rd := '1';
+                else
+                  pf_valid <= '1';
+                  pf_dat <= master_wb_i.dat;
+                end if;
               end if;
-              addr <= std_logic_vector(unsigned(addr) + 4);
               state <= IDLE;
             end if;
         end case;
+        pf_drop <= drop;
+
+        if ack_rd = '1' then
+          --  Read next word ahead.
+          pf_armed <= prefetch and autoinc;
+        end if;
+        if (ack_rd or ack_wr) = '1' then
+          if ack_to_win = '1' then
+            win_ack <= '1';
+          elsif ack_wr = '1' then
+            data_wack_in <= '1';
+          else
+            data_rack_in <= '1';
+          end if;
+        end if;
       end if;
     end if;
   end process;
 
-  master_wb_o <= (cyc => stb,
+  window_in <= (ack => win_ack,
+                err => '0',
+                rty => '0',
+                stall => '0',
+                dat => data);
+
+  master_wb_o <= (cyc => cyc,
                   stb => stb,
-                  adr => addr,
+                  adr => m_adr,
                   sel => "1111",
                   we  => we,
-                  dat => data);
+                  dat => m_dat);
 
   inst_regs: entity work.wb_indirect_regs
     port map (
-      rst_n_i     => rst_n_i,
-      clk_i       => clk_i,
-      wb_i        => wb_i,
-      wb_o        => wb_o,
-      addr_i      => addr,
-      addr_o      => addr_out,
-      addr_wr_o   => addr_wr_out,
-      data_i      => data,
-      data_o      => data_out,
-      data_wr_o   => data_wr_out,
-      data_rd_o   => data_rd_out,
-      data_wack_i => data_wack_in,
-      data_rack_i => data_rack_in);
+      rst_n_i         => rst_n_i,
+      clk_i           => clk_i,
+      wb_i            => wb_i,
+      wb_o            => wb_o,
+      addr_i          => addr,
+      addr_o          => addr_out,
+      addr_wr_o       => addr_wr_out,
+      data_i          => data,
+      data_o          => data_out,
+      data_wr_o       => data_wr_out,
+      data_rd_o       => data_rd_out,
+      data_wack_i     => data_wack_in,
+      data_rack_i     => data_rack_in,
+      ctrl_autoinc_o  => autoinc,
+      ctrl_prefetch_o => prefetch,
+      ctrl_wr_o       => ctrl_wr_out,
+      window_i        => window_in,
+      window_o        => window_out);
 end arch;
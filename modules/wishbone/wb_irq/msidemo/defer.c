@@ -0,0 +1,95 @@
+/** @file defer.c
+ *  @brief Deferred (bottom half) work for MSI handlers on the LM32
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#include "defer.h"
+
+#if IRQ_DEFER_SIZE & (IRQ_DEFER_SIZE - 1)
+#error IRQ_DEFER_SIZE must be a power of 2
+#endif
+
+//keep the compiler from moving item accesses across the index updates
+#define DEFER_BARRIER() asm volatile ("" : : : "memory")
+
+typedef struct
+{
+   defer_fn_t fn;
+   msi        m;
+} defer_item;
+
+static defer_item defer_ring[IRQ_DEFER_SIZE];
+//head is only written by ISRs, tail only by main, both free running
+static volatile unsigned int defer_head, defer_tail;
+
+volatile unsigned int irq_defer_drops;
+
+int irq_defer(defer_fn_t fn, msi* m)
+{
+  unsigned int head;
+  defer_item* item;
+  int ret = 0;
+#ifdef IRQ_NESTED
+  unsigned int ie, tmp;
+
+  asm volatile ("rcsr %0, IE\n" \
+                "andi %1, %0, 0xFFFE\n" \
+                "wcsr IE, %1" : "=&r" (ie), "=&r" (tmp));
+#endif
+
+  head = defer_head;
+  if(head - defer_tail < IRQ_DEFER_SIZE)
+  {
+    item = &defer_ring[head & (IRQ_DEFER_SIZE - 1)];
+    item->fn = fn;
+    item->m  = *m;
+    DEFER_BARRIER();
+    defer_head = head + 1; //publish the item
+    ret = 1;
+  }
+  else irq_defer_drops++;
+
+#ifdef IRQ_NESTED
+  asm volatile ("wcsr IE, %0" : : "r" (ie));
+#endif
+  return ret;
+}
+
+unsigned int irq_defer_run(void)
+{
+  unsigned int tail = defer_tail;
+  unsigned int n = 0;
+  defer_item* item;
+#ifdef IRQ_CYCLES
+  unsigned int t0 = IRQ_CYCLES();
+#endif
+
+  while(tail != defer_head)
+  {
+    DEFER_BARRIER();
+    item = &defer_ring[tail & (IRQ_DEFER_SIZE - 1)];
+    item->fn(&item->m);   //the slot stays ours until tail moves on
+    DEFER_BARRIER();
+    defer_tail = ++tail;
+    n++;
+  }
+
+#ifdef IRQ_CYCLES
+  if(n) irq_acct.defer += IRQ_CYCLES() - t0;
+#endif
+  return n;
+}
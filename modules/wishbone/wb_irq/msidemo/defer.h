@@ -0,0 +1,60 @@
+/** @file defer.h
+ *  @brief Deferred (bottom half) work for MSI handlers on the LM32
+ *
+ *  Usage:
+ *
+ *  void <some work>(msi* m) { <slow part of the handling> }
+ *  ...
+ *  void <an ISR>(msi* m) { <urgent part>; irq_defer(<some work>, m); }
+ *  ...
+ *  void main(void) {
+ *    ...
+ *    while(1) {
+ *      irq_defer_run(); //runs queued work with interrupts enabled
+ *      ...
+ *    }
+ *  }
+ *
+ *  ISRs push work items into a single producer/single consumer ring, main
+ *  pops them. An item holds the function and a copy of the message. With
+ *  IRQ_NESTED, ISRs of different priorities are several producers, so
+ *  irq_defer() then pushes with interrupts off.
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#ifndef __DEFER_H_
+#define __DEFER_H_
+
+#include "irq.h"
+
+//ring entries, must be a power of 2
+#ifndef IRQ_DEFER_SIZE
+#define IRQ_DEFER_SIZE 16
+#endif
+
+typedef void (*defer_fn_t)(msi* m);
+
+//items lost because the ring was full
+extern volatile unsigned int irq_defer_drops;
+
+//ISR side: queue fn(m), returns 0 if the ring is full
+int irq_defer(defer_fn_t fn, msi* m);
+
+//main side: run all queued items, returns their number
+unsigned int irq_defer_run(void);
+
+#endif
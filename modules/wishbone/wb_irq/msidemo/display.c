@@ -13,9 +13,35 @@ const char MODE_IDLE	= 0x00;
 
 const char ROW_LEN = 11;
 
+//last mode written, -1: unknown. Updated before the register, so an ISR
+//entered in between saves the new mode and writes it back on exit
+static volatile int disp_cur_mode = -1;
+
+//write the mode register only if the mode changes
+static void disp_mode(char mode)
+{
+	if(disp_cur_mode != mode)
+	{
+		disp_cur_mode = mode;
+		*(display + (REG_MODE>>2)) = (unsigned int)mode;
+	}
+}
+
+int disp_get_mode()
+{
+	return disp_cur_mode;
+}
+
+void disp_set_mode(int mode)
+{
+	if(mode < 0)	disp_cur_mode = -1;	//forget, the next access writes it
+	else		disp_mode(mode);
+}
+
 void disp_reset()
 {
-	*(display + REG_RST) = 1;
+	disp_cur_mode = -1;
+	*(display + (REG_RST>>2)) = 1;
 }
 
 
@@ -24,14 +50,14 @@ void disp_reset()
 void disp_put_c(char ascii)
 {
 
-	*(display + (REG_MODE>>2)) = (unsigned int)MODE_UART;
+	disp_mode(MODE_UART);
 	*(display + (REG_UART>>2)) = (unsigned int)ascii;
 }
 
 
 void disp_put_str(const char *sPtr)
 {
-	*(display + (REG_MODE>>2)) = (unsigned int)MODE_UART;
+	disp_mode(MODE_UART);
 	while(*sPtr != '\0') *(display + (REG_UART>>2)) = (unsigned int)*sPtr++;
 }
 
@@ -55,7 +81,7 @@ void disp_loc_c(char ascii, unsigned char row, unsigned char col)
 {
 	unsigned int rowcol;
 	
-	*(display + (REG_MODE>>2)) = (unsigned int)MODE_CHAR;
+	disp_mode(MODE_CHAR);
 	rowcol = ((0x07 & (unsigned int)row)<<6) + ((0x0f & (unsigned int)col)<<2);
 	*(display + ((REG_CHAR + rowcol)>>2)) = (unsigned int)ascii;
 
@@ -66,7 +92,7 @@ void disp_put_raw(char pixcol, unsigned int address, char color)
 	char oldpixcol;
 
 		
-	*(display + (REG_MODE>>2)) = (unsigned int)MODE_RAW;
+	disp_mode(MODE_RAW);
 	oldpixcol = *(display + (REG_RAW>>2) + ((address & 0x3FFF))); //read out old memcontent
 	
 	if(color) // 1 -> White
@@ -74,7 +100,7 @@ void disp_put_raw(char pixcol, unsigned int address, char color)
 	else
 		*(display + (REG_RAW>>2) + ((address & 0x3FFF))) = (unsigned int)(~pixcol & oldpixcol);
 
-	*(display + (REG_MODE>>2)) = (unsigned int)MODE_IDLE;
+	disp_mode(MODE_IDLE);
 
 }
 
@@ -97,3 +123,257 @@ unsigned int get_pixcol_val(unsigned char y_in)
 	return 1<<(y_in & 0x07); 
 
 }
+
+
+/* Framebuffer: a copy of the pixel columns in RAM. Drawing only changes
+ * the copy and widens the dirty column range of the page(s) touched,
+ * disp_fb_flush() writes the dirty columns in one RAW mode pass, no read
+ * back. A page is a row of 8 pixel high columns, bit 0 is the top pixel.
+ * Start with disp_fb_load() or disp_fb_clear(), flushing overwrites whole
+ * columns, so text written to the display meanwhile needs another load.
+ */
+#define FB_W		64
+#define FB_H		48
+#define FB_PAGES	(FB_H/8)
+
+static unsigned char fb[FB_PAGES][FB_W];
+static unsigned char fb_x0[FB_PAGES] = {FB_W, FB_W, FB_W, FB_W, FB_W, FB_W};	//dirty columns x0..x1,
+static unsigned char fb_x1[FB_PAGES];						//clean if x0 > x1
+
+static void fb_dirty(unsigned char page, unsigned char x0, unsigned char x1)
+{
+	if(fb_x0[page] > fb_x1[page]) {fb_x0[page] = x0; fb_x1[page] = x1; return;}	//was clean
+	if(x0 < fb_x0[page]) fb_x0[page] = x0;
+	if(x1 > fb_x1[page]) fb_x1[page] = x1;
+}
+
+void disp_fb_clear(char color)
+{
+	unsigned char page, x;
+	unsigned char val = color ? 0xFF : 0x00;
+
+	for(page=0; page<FB_PAGES; page++)
+	{
+		for(x=0; x<FB_W; x++) fb[page][x] = val;
+		fb_dirty(page, 0, FB_W-1);
+	}
+}
+
+void disp_fb_load()
+{
+	unsigned char page, x;
+
+	disp_mode(MODE_RAW);
+	for(page=0; page<FB_PAGES; page++)
+	{
+		for(x=0; x<FB_W; x++)
+			fb[page][x] = *(display + (REG_RAW>>2) + get_pixcol_addr(x, page<<3));
+		fb_x0[page] = FB_W; fb_x1[page] = 0;	//in sync
+	}
+	disp_mode(MODE_IDLE);
+}
+
+void disp_fb_pixel(unsigned char x, unsigned char y, char color)
+{
+	unsigned char page, bit;
+
+	if(x >= FB_W || y >= FB_H) return;	//clipped
+	page = y>>3;
+	bit  = get_pixcol_val(y);
+	if(color)	fb[page][x] |= bit;
+	else		fb[page][x] &= ~bit;
+	fb_dirty(page, x, x);
+}
+
+void disp_fb_line(int x0, int y0, int x1, int y1, char color)
+{
+	//Bresenham, all octants
+	int dx  = (x1 > x0) ? x1 - x0 : x0 - x1;
+	int dy  = (y1 > y0) ? y0 - y1 : y1 - y0;
+	int sx  = (x0 < x1) ? 1 : -1;
+	int sy  = (y0 < y1) ? 1 : -1;
+	int err = dx + dy, e2;
+
+	while(1)
+	{
+		if(x0 >= 0 && x0 < FB_W && y0 >= 0 && y0 < FB_H) disp_fb_pixel(x0, y0, color);
+		if(x0 == x1 && y0 == y1) break;
+		e2 = err + err;
+		if(e2 >= dy) {err += dy; x0 += sx;}
+		if(e2 <= dx) {err += dx; y0 += sy;}
+	}
+}
+
+void disp_fb_rect(unsigned char x, unsigned char y, unsigned char w, unsigned char h, char color, char fill)
+{
+	unsigned char page, col, x1, y1, mask;
+
+	if(!w || !h || x >= FB_W || y >= FB_H) return;
+	x1 = (x + w > FB_W) ? FB_W-1 : x + w - 1;
+	y1 = (y + h > FB_H) ? FB_H-1 : y + h - 1;
+
+	if(!fill)
+	{
+		disp_fb_line(x, y, x1, y, color);
+		disp_fb_line(x, y1, x1, y1, color);
+		disp_fb_line(x, y, x, y1, color);
+		disp_fb_line(x1, y, x1, y1, color);
+		return;
+	}
+
+	//filled: one masked write per column and page
+	for(page=y>>3; page<=(y1>>3); page++)
+	{
+		mask = 0xFF;
+		if(page == (y>>3))  mask &= 0xFF << (y & 7);
+		if(page == (y1>>3)) mask &= 0xFF >> (7 - (y1 & 7));
+		for(col=x; col<=x1; col++)
+		{
+			if(color)	fb[page][col] |= mask;
+			else		fb[page][col] &= ~mask;
+		}
+		fb_dirty(page, x, x1);
+	}
+}
+
+void disp_fb_blit(unsigned char x, unsigned char y, unsigned char w, unsigned char h, const unsigned char* bits)
+{
+	//bits: h rows of (w+7)/8 bytes, MSB is the leftmost pixel, 1 is white
+	unsigned char row, col, stride = (w+7)>>3;
+
+	for(row=0; row<h && y+row<FB_H; row++, bits += stride)
+		for(col=0; col<w && x+col<FB_W; col++)
+			disp_fb_pixel(x+col, y+row, bits[col>>3] & (0x80 >> (col & 7)));
+}
+
+unsigned int disp_fb_flush()
+{
+	unsigned char page, x;
+	volatile unsigned int* raw;
+	unsigned int n = 0;
+
+	for(page=0; page<FB_PAGES; page++)
+	{
+		if(fb_x0[page] > fb_x1[page]) continue;	//clean
+		disp_mode(MODE_RAW);
+		raw = display + (REG_RAW>>2) + get_pixcol_addr(0, page<<3);
+		for(x=fb_x0[page]; x<=fb_x1[page]; x++, n++) raw[x] = fb[page][x];
+		fb_x0[page] = FB_W; fb_x1[page] = 0;
+	}
+	if(n) disp_mode(MODE_IDLE);
+
+	return n;	//columns written
+}
+
+
+/* Text console: a copy of the CHAR mode cells in RAM and a damage bit per
+ * cell. Writing only marks cells whose character changes, disp_con_flush()
+ * writes the marked cells in one CHAR mode pass. disp_con_puts() writes at
+ * the cursor: '\n' blanks the rest of the line and starts the next one,
+ * '\f' clears the console, long lines wrap, the last line scrolls up.
+ * Start with disp_con_clear().
+ */
+#define CON_ROWS	(FB_H/8)
+#define CON_COLS	11	//ROW_LEN
+
+static char con_txt[CON_ROWS][CON_COLS];
+static unsigned short con_dmg[CON_ROWS];	//bit n: column n changed
+static unsigned char con_row, con_col;		//cursor
+
+static void con_set(unsigned char row, unsigned char col, char ascii)
+{
+	if(con_txt[row][col] != ascii)
+	{
+		con_txt[row][col] = ascii;
+		con_dmg[row] |= 1 << col;
+	}
+}
+
+static void con_newline()
+{
+	unsigned char row, col;
+
+	con_col = 0;
+	if(con_row < CON_ROWS-1) {con_row++; return;}
+
+	for(row=1; row<CON_ROWS; row++)	//scroll, only changed cells get damaged
+		for(col=0; col<CON_COLS; col++) con_set(row-1, col, con_txt[row][col]);
+	for(col=0; col<CON_COLS; col++) con_set(CON_ROWS-1, col, ' ');
+}
+
+void disp_con_clear()
+{
+	unsigned char row, col;
+
+	for(row=0; row<CON_ROWS; row++)
+	{
+		for(col=0; col<CON_COLS; col++) con_txt[row][col] = ' ';
+		con_dmg[row] = (1 << CON_COLS) - 1;	//display content is unknown
+	}
+	con_row = con_col = 0;
+}
+
+void disp_con_goto(unsigned char row, unsigned char col)
+{
+	if(row < CON_ROWS && col < CON_COLS) {con_row = row; con_col = col;}
+}
+
+void disp_con_putc(char ascii)
+{
+	if(ascii == '\f')
+	{
+		unsigned char row, col;
+		for(row=0; row<CON_ROWS; row++)
+			for(col=0; col<CON_COLS; col++) con_set(row, col, ' ');
+		con_row = con_col = 0;
+	}
+	else if(ascii == '\n')
+	{
+		while(con_col < CON_COLS) con_set(con_row, con_col++, ' ');
+		con_newline();
+	}
+	else
+	{
+		if(con_col == CON_COLS) con_newline();	//wrap
+		con_set(con_row, con_col++, ascii);
+	}
+}
+
+void disp_con_puts(const char *sPtr)
+{
+	while(*sPtr != '\0') disp_con_putc(*sPtr++);
+}
+
+void disp_con_put_line(const char *sPtr, unsigned char row)
+{
+	unsigned char col;
+
+	if(row >= CON_ROWS) return;
+	for(col=0; col<CON_COLS; col++)
+		con_set(row, col, (*sPtr != '\0') ? *sPtr++ : ' ');
+}
+
+unsigned int disp_con_flush()
+{
+	unsigned char row, col;
+	unsigned short dmg, bit;
+	volatile unsigned int* cells;
+	unsigned int n = 0;
+
+	for(row=0; row<CON_ROWS; row++)
+	{
+		if(!(dmg = con_dmg[row])) continue;
+		disp_mode(MODE_CHAR);
+		cells = display + (REG_CHAR>>2) + (row<<4);	//16 cells per row
+		for(col=0, bit=1; dmg; col++, bit<<=1)
+		{
+			if(!(dmg & bit)) continue;
+			cells[col] = (unsigned int)con_txt[row][col];
+			dmg &= ~bit;
+			n++;
+		}
+		con_dmg[row] = 0;
+	}
+
+	return n;	//cells written
+}
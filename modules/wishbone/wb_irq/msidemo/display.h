@@ -21,6 +21,11 @@ void disp_put_line(const char *sPtr, unsigned char row);
 
 void disp_reset();
 
+//mode register cache, -1: unknown. Code using the display from ISRs and
+//main should save the mode on ISR entry and set it again before leaving.
+int  disp_get_mode();
+void disp_set_mode(int mode);
+
 void disp_loc_c(char ascii, unsigned char row, unsigned char col);
 void disp_put_raw(char pixcol, unsigned int address, char color);
 
@@ -28,5 +33,22 @@ unsigned int get_pixcol_addr(unsigned char x_in, unsigned char y_in);
 
 unsigned int get_pixcol_val(unsigned char y_in);
 
+//RAM framebuffer, drawing is flushed to the display by disp_fb_flush()
+void disp_fb_clear(char color);
+void disp_fb_load();
+void disp_fb_pixel(unsigned char x, unsigned char y, char color);
+void disp_fb_line(int x0, int y0, int x1, int y1, char color);
+void disp_fb_rect(unsigned char x, unsigned char y, unsigned char w, unsigned char h, char color, char fill);
+void disp_fb_blit(unsigned char x, unsigned char y, unsigned char w, unsigned char h, const unsigned char* bits);
+unsigned int disp_fb_flush();
+
+//text console, changed cells are written by disp_con_flush()
+void disp_con_clear();
+void disp_con_goto(unsigned char row, unsigned char col);
+void disp_con_putc(char ascii);
+void disp_con_puts(const char *sPtr);
+void disp_con_put_line(const char *sPtr, unsigned char row);
+unsigned int disp_con_flush();
+
 
 #endif 
@@ -0,0 +1,189 @@
+/** @file irq_bench.c
+ *  @brief MSI flood benchmark for irq.c on the wb_irq_slave model
+ *
+ *  Every queue gets an MSI source sending n msgs, one every period time
+ *  units (queue 0 skew times as often). Time is counted in ctrl bus
+ *  accesses of the handler, plus entry units per interrupt, isr units per
+ *  ISR call and one unit per idle loop. A source whose queue is full
+ *  stalls until there is room again, as on the bus ("stalled": time units
+ *  a source waited). Reports dispatch throughput, stalls and the per queue
+ *  latency with Jain's fairness index of the mean latencies. Exits with 1
+ *  on lost or reordered msgs.
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include "irq.h"
+#include "wb_irq_model.h"
+
+#define SRC_ADR(q) (0x100 + ((q) << 2))
+
+typedef struct
+{
+   unsigned long next;    //time the next msg is due
+   unsigned long stall;   //time units spent stalled
+   unsigned int  sent, rcvd;
+   unsigned long lat_sum, lat_max;
+   unsigned long* due;    //due time per msg
+} source;
+
+static source*       src;
+static unsigned int  n_src, n_msgs, period, skew, isr_cost, entry_cost;
+static unsigned long now, errors;
+
+static void produce(void)
+{
+  unsigned int i;
+  source* s;
+
+  now++;
+  for(i=0;i<n_src;i++)
+  {
+    s = &src[i];
+    if(s->sent == n_msgs || s->next > now) continue;
+    if(wb_irq_model_push(i, s->sent, SRC_ADR(i), 0xf))
+    {
+      s->due[s->sent++] = s->next;
+      s->next += (i == 0) ? period / skew : period;
+    }
+    else s->stall++;
+  }
+}
+
+static void isr(msi* m)
+{
+  unsigned int i = (m->src - SRC_ADR(0)) >> 2;
+  unsigned long lat;
+  source* s;
+
+  if(i >= n_src || m->msg != src[i].rcvd || m->sel != 0xf)
+  {
+    errors++;
+    return;
+  }
+  s   = &src[i];
+  lat = now - s->due[s->rcvd++];
+  s->lat_sum += lat;
+  if(lat > s->lat_max) s->lat_max = lat;
+
+  for(i=0;i<isr_cost;i++) produce();
+}
+
+void _irq_entry(void)
+{
+  unsigned int i;
+  for(i=0;i<entry_cost;i++) produce();
+  irq_process();
+}
+
+static int done(void)
+{
+  unsigned int i;
+  for(i=0;i<n_src;i++)
+    if(src[i].rcvd != n_msgs) return 0;
+  return 1;
+}
+
+static void usage(const char* name)
+{
+  fprintf(stderr, "usage: %s [-q queues] [-d depth] [-n msgs] [-p period] "
+          "[-s skew] [-c isr cost] [-e entry cost]\n", name);
+  exit(2);
+}
+
+int main(int argc, char** argv)
+{
+  unsigned int depth = 8, i, entries = 0;
+  unsigned long dispatched = 0;
+  double mean, sum = 0, sum2 = 0, secs;
+  struct timespec t0, t1;
+  int c;
+
+  n_src = 4; n_msgs = 100000; period = 100; skew = 1;
+  isr_cost = 10; entry_cost = 40;
+  while((c = getopt(argc, argv, "q:d:n:p:s:c:e:")) != -1)
+  {
+    switch(c)
+    {
+      case 'q': n_src      = atoi(optarg); break;
+      case 'd': depth      = atoi(optarg); break;
+      case 'n': n_msgs     = atoi(optarg); break;
+      case 'p': period     = atoi(optarg); break;
+      case 's': skew       = atoi(optarg); break;
+      case 'c': isr_cost   = atoi(optarg); break;
+      case 'e': entry_cost = atoi(optarg); break;
+      default:  usage(argv[0]);
+    }
+  }
+  if(!n_msgs || !period || !skew || !wb_irq_model_init(n_src, depth))
+    usage(argv[0]);
+
+  src = calloc(n_src, sizeof(source));
+  for(i=0;i<n_src;i++)
+    if(!src || !(src[i].due = malloc(n_msgs * sizeof(unsigned long))))
+    {
+      perror("malloc");
+      return 2;
+    }
+
+  isr_table_clr();
+  for(i=0;i<n_src;i++) isr_ptr_table[i] = isr;
+  wb_irq_model_tick = produce;
+  irq_set_mask((n_src < 32) ? (1u << n_src) - 1 : ~0u);
+  irq_enable();
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  while(!done() && !errors)
+  {
+    if(wb_irq_model_irq())
+    {
+      wb_irq_model_exception(_irq_entry);
+      entries++;
+    }
+    else produce();
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+
+  printf("queues %u, depth %u, msgs %u per queue, period %u (queue 0: %u), "
+         "isr %u, entry %u\n", n_src, depth, n_msgs, period, period / skew,
+         isr_cost, entry_cost);
+  printf("%-6s %10s %10s %10s %10s\n", "queue", "msgs", "stalled", "lat mean", "lat max");
+  for(i=0;i<n_src;i++)
+  {
+    mean = src[i].rcvd ? (double)src[i].lat_sum / src[i].rcvd : 0;
+    sum  += mean;
+    sum2 += mean * mean;
+    dispatched += src[i].rcvd;
+    printf("%-6u %10u %10lu %10.1f %10lu\n", i, src[i].rcvd, src[i].stall,
+           mean, src[i].lat_max);
+  }
+  printf("time %lu, interrupts %u, msgs per interrupt %.2f\n",
+         now, entries, entries ? (double)dispatched / entries : 0);
+  printf("bus accesses per msg %.2f (%lu rd, %lu wr), stalled pushes %lu\n",
+         (double)(wb_irq_model_stat.rd + wb_irq_model_stat.wr) / dispatched,
+         wb_irq_model_stat.rd, wb_irq_model_stat.wr, wb_irq_model_stat.stall);
+  printf("fairness (Jain, mean latency) %.3f\n",
+         sum2 > 0 ? sum * sum / (n_src * sum2) : 1.0);
+  printf("host dispatch rate %.0f msgs/s\n", dispatched / secs);
+
+  if(errors) printf("%lu lost or reordered msgs\n", errors);
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,236 @@
+/** @file wb_irq_model.c
+ *  @brief Software model of wb_irq_slave and the LM32 interrupt CSRs
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#include <stdlib.h>
+#include "wb_irq_model.h"
+
+//register map, see wb_irq_slave.vhd
+#define REG_RST       0x00
+#define REG_STATUS    0x04
+#define REG_POP       0x08
+#define REG_CLEAR     0x0C
+#define REG_ENA_GET   0x10
+#define REG_ENA_SET   0x14
+#define REG_ENA_CLR   0x18
+#define QUEUES        0x20
+#define N_QUEUE       0x10
+#define OFFS_DATA     0x00
+#define OFFS_ADDR     0x04
+#define OFFS_SEL      0x08
+#define OFFS_POP      0x0C
+
+#define PACKED_SEL_BITS 4
+
+typedef struct
+{
+   unsigned int dat, adr, sel;
+} msi_entry;
+
+typedef struct
+{
+   msi_entry*   e;
+   unsigned int head, cnt;
+} msi_queue;
+
+wb_irq_model_stats wb_irq_model_stat;
+void (*wb_irq_model_tick)(void);
+
+static msi_queue    queue[WB_IRQ_MODEL_MAX_QUEUES];
+static unsigned int n_queues, q_size, ena;
+static unsigned int csr_ip, csr_im, csr_ie;
+
+static void tick(void)
+{
+  if(wb_irq_model_tick) wb_irq_model_tick();
+}
+
+static void q_clear( unsigned int mask)
+{
+  unsigned int i;
+  for(i=0;i<n_queues;i++)
+    if(mask & (1u << i)) queue[i].head = queue[i].cnt = 0;
+}
+
+static void q_pop( unsigned int mask)
+{
+  unsigned int i;
+  for(i=0;i<n_queues;i++)
+    if((mask & (1u << i)) && queue[i].cnt)
+    {
+      queue[i].head = (queue[i].head + 1) % q_size;
+      queue[i].cnt--;
+    }
+}
+
+int wb_irq_model_init( unsigned int queues, unsigned int depth)
+{
+  unsigned int i;
+
+  if(!queues || queues > WB_IRQ_MODEL_MAX_QUEUES || depth < 2) return 0;
+
+  for(i=0;i<WB_IRQ_MODEL_MAX_QUEUES;i++)
+  {
+    free(queue[i].e);
+    queue[i].e = 0;
+  }
+  n_queues = queues;
+  q_size   = depth - 1;
+  for(i=0;i<n_queues;i++)
+    if(!(queue[i].e = calloc(q_size, sizeof(msi_entry)))) return 0;
+
+  q_clear(~0u);
+  ena    = ~0u;
+  csr_ip = csr_im = csr_ie = 0;
+  wb_irq_model_stat = (wb_irq_model_stats){0, 0, 0, 0};
+  return 1;
+}
+
+int wb_irq_model_push( unsigned int i, unsigned int dat, unsigned int adr, unsigned int sel)
+{
+  msi_entry* e;
+
+  if(i >= n_queues || queue[i].cnt == q_size || !(ena & (1u << i)))
+  {
+    wb_irq_model_stat.stall++;
+    return 0;
+  }
+  e = &queue[i].e[(queue[i].head + queue[i].cnt) % q_size];
+  e->dat = dat;
+  e->adr = adr;
+  e->sel = sel;
+  queue[i].cnt++;
+  wb_irq_model_stat.push++;
+  return 1;
+}
+
+unsigned int wb_irq_model_lines(void)
+{
+  unsigned int i, lines = 0;
+  for(i=0;i<n_queues;i++)
+    if(queue[i].cnt) lines |= 1u << i;
+  return lines;
+}
+
+int wb_irq_model_irq(void)
+{
+  return (csr_ie & 1) && ((csr_ip | wb_irq_model_lines()) & csr_im);
+}
+
+void wb_irq_model_exception(void (*entry)(void))
+{
+  csr_ie = (csr_ie & ~3u) | ((csr_ie & 1) << 1);   //EIE = IE, IE = 0
+  entry();
+  csr_ie = (csr_ie & ~1u) | ((csr_ie >> 1) & 1);   //eret: IE = EIE
+}
+
+unsigned int wb_irq_model_rd( unsigned int offs)
+{
+  unsigned int i, w;
+  msi_entry* e;
+
+  wb_irq_model_stat.rd++;
+  tick();
+
+  if(offs < QUEUES)
+  {
+    switch(offs)
+    {
+      case REG_STATUS:  return wb_irq_model_lines();
+      case REG_ENA_GET: return ena;
+      default:          return 0; //bus error in the HDL
+    }
+  }
+
+  i = (offs - QUEUES) / N_QUEUE;
+  if(i >= n_queues) return 0;
+  e = &queue[i].e[queue[i].head]; //stale entry if empty, as the HDL
+  switch(offs % N_QUEUE)
+  {
+    case OFFS_DATA: return e->dat;
+    case OFFS_ADDR: return e->adr;
+    case OFFS_SEL:  return e->sel;
+    default:
+#ifdef IRQ_PACKED
+      w = (e->sel << (32 - PACKED_SEL_BITS)) |
+          (e->adr & ((1u << (32 - PACKED_SEL_BITS)) - 1));
+#else
+      w = e->sel;
+#endif
+      q_pop(1u << i);
+      return w;
+  }
+}
+
+void wb_irq_model_wr( unsigned int offs, unsigned int val)
+{
+  wb_irq_model_stat.wr++;
+  tick();
+
+  switch(offs)
+  {
+    case REG_RST:     q_clear(~0u); ena = ~0u; break;
+    case REG_POP:     q_pop(val);         break;
+    case REG_CLEAR:   q_clear(val);       break;
+    case REG_ENA_SET: ena |= val;         break;
+    case REG_ENA_CLR: ena &= ~val;        break;
+    default:                              break;
+  }
+}
+
+unsigned int irq_get_mask(void)
+{
+  return csr_im;
+}
+
+void irq_set_mask( unsigned int im)
+{
+  csr_im = im;
+}
+
+void irq_disable(void)
+{
+  csr_ie &= ~1u;
+}
+
+void irq_enable(void)
+{
+  csr_ie |= 1;
+}
+
+void irq_clear( unsigned int mask)
+{
+  //write 1 to clear, level lines set their bit again
+  csr_ip &= ~mask;
+}
+
+unsigned int irq_get_pending(void)
+{
+  csr_ip |= wb_irq_model_lines();
+  return csr_ip;
+}
+
+unsigned int irq_get_ie(void)
+{
+  return csr_ie;
+}
+
+void irq_set_ie( unsigned int ie)
+{
+  csr_ie = ie;
+}
@@ -0,0 +1,76 @@
+/** @file wb_irq_model.h
+ *  @brief Software model of wb_irq_slave and the LM32 interrupt CSRs
+ *
+ *  Lets irq.c run on a PC: built with IRQ_HOST, irq.c reads and writes the
+ *  wb_irq_slave registers through wb_irq_model_rd()/wb_irq_model_wr() and
+ *  gets its CSR accessors from here. Queue i raises line i while it is not
+ *  empty, like irq_o of the HDL. g_depth-1 msgs fit into a queue, as with
+ *  the legacy show-ahead fifo of the HDL. Reading the POP word of a queue
+ *  (offset 0x0C) pops it as with g_auto_pop, with IRQ_PACKED it returns
+ *  the g_packed word.
+ *
+ *  Every bus access calls wb_irq_model_tick, if set, so a testbench can
+ *  advance its time and produce MSIs while the handler runs.
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#ifndef __WB_IRQ_MODEL_H_
+#define __WB_IRQ_MODEL_H_
+
+#define WB_IRQ_MODEL_MAX_QUEUES 32
+
+typedef struct
+{
+   unsigned long rd;    //ctrl bus reads
+   unsigned long wr;    //ctrl bus writes
+   unsigned long push;  //msi writes accepted
+   unsigned long stall; //msi writes stalled, queue full or disabled
+} wb_irq_model_stats;
+
+extern wb_irq_model_stats wb_irq_model_stat;
+extern void (*wb_irq_model_tick)(void);
+
+//returns 0 if queues or depth are out of range
+int wb_irq_model_init( unsigned int queues, unsigned int depth);
+
+//msi write to queue, returns 0 if it stalls
+int wb_irq_model_push( unsigned int queue, unsigned int dat, unsigned int adr, unsigned int sel);
+
+//irq_o, one bit per non empty queue
+unsigned int wb_irq_model_lines(void);
+
+//1 if the LM32 would take an interrupt now
+int wb_irq_model_irq(void);
+
+//take an interrupt: IE to EIE, call entry, eret
+void wb_irq_model_exception(void (*entry)(void));
+
+//ctrl bus
+unsigned int wb_irq_model_rd( unsigned int offs);
+void wb_irq_model_wr( unsigned int offs, unsigned int val);
+
+//CSR accessors used by irq.c
+unsigned int irq_get_mask(void);
+void irq_set_mask( unsigned int im);
+void irq_disable(void);
+void irq_enable(void);
+void irq_clear( unsigned int mask);
+unsigned int irq_get_pending(void);
+unsigned int irq_get_ie(void);
+void irq_set_ie( unsigned int ie);
+
+#endif
@@ -27,7 +27,28 @@
 
 //#include "display.h" DEBUG
 
-extern unsigned int* irq_slave;
+#ifdef IRQ_HOST
+//host build: registers and CSRs are those of the model in host/
+#include "wb_irq_model.h"
+#define irq_rd(offs)    wb_irq_model_rd(offs)
+#define irq_wr(offs, v) wb_irq_model_wr(offs, v)
+#else
+extern volatile unsigned int* irq_slave;
+
+static inline unsigned int irq_rd( unsigned int offs)
+{
+  return *(irq_slave + (offs>>2));
+}
+
+static inline void irq_wr( unsigned int offs, unsigned int val)
+{
+  *(irq_slave + (offs>>2)) = val;
+}
+#endif
+
+#ifdef IRQ_CYCLES
+volatile irq_acct_t irq_acct;
+#endif
 
 const unsigned int IRQ_REG_RST 	= 0x00000000;
 const unsigned int IRQ_REG_STAT = 0x00000004;
@@ -35,19 +56,105 @@ const unsigned int IRQ_REG_POP	= 0x00000008;
 const unsigned int IRQ_OFFS_MSG = 0x00000000;
 const unsigned int IRQ_OFFS_SRC = 0x00000004;
 const unsigned int IRQ_OFFS_SEL	= 0x00000008;
+const unsigned int IRQ_OFFS_POP	= 0x0000000C;
+const unsigned int IRQ_QUEUES	= 0x00000020;
+const unsigned int IRQ_N_QUEUE	= 0x00000010;
 
-inline void irq_pop_msi( unsigned int irq_no)
+//lowest pending irq number lookup, see irq_lowest()
+#if defined(__multiply_enabled__) && defined(__barrel_shift_enabled__)
+static const unsigned char irq_debruijn[32] =
 {
-    unsigned int* msg_queue = (unsigned int*)(irq_slave + ((irq_no +1)<<2));
+   0,  1, 28,  2, 29, 14, 24,  3, 30, 22, 20, 15, 25, 17,  4,  8,
+  31, 27, 13, 23, 21, 19, 16,  7, 26, 12, 18,  6, 11,  5, 10,  9
+};
+#else
+#define IRQ_CTZ4(n)   n, 0, 1, 0
+#define IRQ_CTZ8(n)   IRQ_CTZ4(n),   IRQ_CTZ4(2)
+#define IRQ_CTZ16(n)  IRQ_CTZ8(n),   IRQ_CTZ8(3)
+#define IRQ_CTZ32(n)  IRQ_CTZ16(n),  IRQ_CTZ16(4)
+#define IRQ_CTZ64(n)  IRQ_CTZ32(n),  IRQ_CTZ32(5)
+#define IRQ_CTZ128(n) IRQ_CTZ64(n),  IRQ_CTZ64(6)
+
+//number of trailing zeros of a byte
+static const unsigned char irq_ctz8[256] = { IRQ_CTZ128(0), IRQ_CTZ128(7) };
+
+//index of byte n (0 = bits 7..0) of a word in memory
+#if defined(__lm32__) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define IRQ_BYTE(n) (3 - (n))
+#else
+#define IRQ_BYTE(n) (n)
+#endif
+#endif
+
+//returns the number of the lowest set bit in ip, ip must not be 0
+static inline unsigned int irq_lowest(unsigned int ip)
+{
+#if defined(__multiply_enabled__) && defined(__barrel_shift_enabled__)
+  //isolate the lowest bit, de Bruijn multiply & lookup: 5 instructions
+  return irq_debruijn[((ip & -ip) * 0x077CB531u) >> 27];
+#else
+  //no barrel shifter (minimal profile): byte-wise table lookup, no shift
+  const unsigned char* b = (const unsigned char*)&ip;
+
+  if(b[IRQ_BYTE(0)]) return      irq_ctz8[b[IRQ_BYTE(0)]];
+  if(b[IRQ_BYTE(1)]) return  8 + irq_ctz8[b[IRQ_BYTE(1)]];
+  if(b[IRQ_BYTE(2)]) return 16 + irq_ctz8[b[IRQ_BYTE(2)]];
+  return                    24 + irq_ctz8[b[IRQ_BYTE(3)]];
+#endif
+}
+
+//pop msg of queue irq_no into m, bit is 1<<irq_no
+static inline void irq_pop_msi_bit( unsigned int irq_no, unsigned int bit, msi* m)
+{
+    unsigned int msg_queue = IRQ_QUEUES + irq_no * IRQ_N_QUEUE;
+#if defined(IRQ_PACKED)
+    unsigned int w;
+#endif
     
-    global_msi.msg =  *(msg_queue+(IRQ_OFFS_MSG>>2));
-    global_msi.src =  *(msg_queue+(IRQ_OFFS_SRC>>2)); 
-    global_msi.sel =  *(msg_queue+(IRQ_OFFS_SEL>>2));
-    *(irq_slave + (IRQ_REG_POP>>2)) = 1<<irq_no;   
+    m->msg =  irq_rd(msg_queue + IRQ_OFFS_MSG);
+#if defined(IRQ_PACKED)
+    //2 reads: sel & adr come in one word, reading it pops the msg
+    w      =  irq_rd(msg_queue + IRQ_OFFS_POP);
+    m->src =  w & IRQ_PACKED_ADR_MASK;
+    m->sel =  w >> IRQ_PACKED_SEL_SHIFT;
+#elif defined(IRQ_AUTO_POP)
+    //3 reads: reading the sel word pops the msg
+    m->src =  irq_rd(msg_queue + IRQ_OFFS_SRC); 
+    m->sel =  irq_rd(msg_queue + IRQ_OFFS_POP);
+#else
+    m->src =  irq_rd(msg_queue + IRQ_OFFS_SRC); 
+    m->sel =  irq_rd(msg_queue + IRQ_OFFS_SEL);
+    irq_wr(IRQ_REG_POP, bit);   
+#endif
+}
+
+inline void irq_pop_msi( unsigned int irq_no, msi* m)
+{
+    irq_pop_msi_bit(irq_no, 1<<irq_no, m);
     
     return; 
 } 
 
+//pop and handle all msgs of queue irq_no (up to IRQ_QUEUE_BATCH)
+static inline void irq_drain_queue( unsigned int irq_no, unsigned int bit)
+{
+    msi m;
+    isr_ptr_t isr = isr_ptr_table[irq_no];
+#if IRQ_QUEUE_BATCH
+    unsigned int n = IRQ_QUEUE_BATCH;
+#endif
+
+    do
+    {
+      irq_pop_msi_bit(irq_no, bit, &m);
+      if(isr) isr(&m);  //execute isr
+      //else disp_put_str("No ISR\nptr found!\n"); DEBUG
+#if IRQ_QUEUE_BATCH
+      if(!--n) break;
+#endif
+    } while(irq_rd(IRQ_REG_STAT) & bit); //more msgs queued ?
+}
+
 inline void isr_table_clr(void)
 {
   //set all ISR table entries to Null
@@ -55,6 +162,7 @@ inline void isr_table_clr(void)
   for(i=0;i<32;i++)  isr_ptr_table[i] = 0; 
 }
 
+#ifndef IRQ_HOST
 inline  unsigned int  irq_get_mask(void)
 {
 	 //read IRQ mask
@@ -66,7 +174,7 @@ inline  unsigned int  irq_get_mask(void)
 inline void irq_set_mask( unsigned int im)
 {
 	 //write IRQ mask
-	 asm volatile (	"wcsr im, %0": "=&r" (im));
+	 asm volatile (	"wcsr im, %0": : "r" (im));
 	 return;	             	
 }
 
@@ -102,27 +210,107 @@ inline void irq_clear( unsigned int mask)
 
 
 
-inline void irq_process(void)
+inline unsigned int irq_get_pending(void)
 {
-  char buffer[12];
-   
+  //read pending flags
   unsigned int ip;
-  unsigned char irq_no = 0;
-  
-  //get pending flags
   asm volatile ("rcsr %0, ip": "=r"(ip));
+  return ip;
+}
 
-  while(ip) //irqs pending ?
+static inline unsigned int irq_get_ie(void)
+{
+  unsigned int ie;
+  asm volatile ("rcsr %0, IE": "=r"(ie));
+  return ie;
+}
+
+static inline void irq_set_ie( unsigned int ie)
+{
+  asm volatile ("wcsr IE, %0": : "r"(ie));
+}
+#endif
+
+#ifdef IRQ_NESTED
+//lines allowed to preempt the ISR of a line: all lines of higher priority
+static unsigned int  irq_preempt[32];
+static unsigned char irq_prio[32];
+
+//returns -1 and changes nothing if irq_no > 31 or prio > 255
+int irq_set_prio( unsigned int irq_no, unsigned int prio)
+{
+  unsigned int i, j, bit;
+
+  if(irq_no >= 32 || prio > 255) return -1;
+  irq_prio[irq_no] = prio;
+  for(i=0;i<32;i++)
+  {
+    irq_preempt[i] = 0;
+    for(j=0, bit=1;j<32;j++, bit+=bit)
+      if(irq_prio[j] > irq_prio[i]) irq_preempt[i] |= bit;
+  }
+  return 0;
+}
+
+inline void irq_process(void)
+{
+  unsigned int ip, m, bit;
+  unsigned int irq_no;
+  unsigned int im = irq_get_mask(); //lines enabled in the interrupted context
+  unsigned int ie = irq_get_ie();   //EIE, overwritten by a nested exception
+#ifdef IRQ_CYCLES
+  unsigned int t0 = IRQ_CYCLES();
+#endif
+
+  while((ip = irq_get_pending() & im)) //irqs pending ?
   {
-    if(ip & 0x01) //check if irq with lowest number is pending
+    //highest priority first, lowest number among equals
+    m = ip;
+    do
     {
-      irq_pop_msi(irq_no);      //pop msg from msi queue into global_msi variable
-      irq_clear(1<<irq_no);     //clear pending bit
-      if((unsigned int)isr_ptr_table[irq_no]) isr_ptr_table[irq_no]();  //execute isr
-      //else disp_put_str("No ISR\nptr found!\n"); DEBUG
-    }  
-    irq_no++; 
-    ip = ip >> 1; //process next irq
+      bit    = m & -m;
+      irq_no = irq_lowest(m);
+      m      = ip & irq_preempt[irq_no];
+    } while(m);
+
+    irq_set_mask(im & irq_preempt[irq_no]); //only higher priorities may preempt
+    irq_enable();
+    irq_drain_queue(irq_no, bit); //pop msgs from msi queue and execute isr
+    irq_disable();
+    irq_set_mask(im);
+    irq_clear(bit);               //clear pending bit, set again if msgs are left
+  }
+#ifdef IRQ_CYCLES
+  irq_acct.isr += IRQ_CYCLES() - t0;
+#endif
+  irq_set_ie(ie);
+  return;
+}
+#else
+inline void irq_process(void)
+{
+  unsigned int ip, bit;
+  unsigned int irq_no;
+#ifdef IRQ_CYCLES
+  unsigned int t0 = IRQ_CYCLES();
+#endif
+  
+  //get pending flags, again after each pass: MSIs arriving meanwhile
+  //are handled without a new exception entry
+  while((ip = irq_get_pending())) //irqs pending ?
+  {
+    do
+    {
+      irq_no = irq_lowest(ip);  //irq with lowest number is served first
+      bit    = ip & -ip;
+      irq_drain_queue(irq_no, bit); //pop msgs from msi queue and execute isr
+      irq_clear(bit);           //clear pending bit, set again if msgs are left
+      ip &= ip - 1;             //process next irq
+    } while(ip);
   }
+#ifdef IRQ_CYCLES
+  irq_acct.isr += IRQ_CYCLES() - t0;
+#endif
   return;
 }  
+#endif
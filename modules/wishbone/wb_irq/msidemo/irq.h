@@ -5,7 +5,7 @@
  *
  *  Usage:
  * 
- *  void <an ISR>(void) { <evaluate global_msi and do something useful> }
+ *  void <an ISR>(msi* m) { <evaluate *m and do something useful> }
  *  ...
  *  void _irq_entry(void) {irq_process();}
  *  ...
@@ -20,6 +20,29 @@
  *    ...
  *  }
  *  
+ *  All the messages of a queue are handled in one pass: the ISR is called
+ *  once per message. Define IRQ_QUEUE_BATCH to limit the number of messages
+ *  taken from one queue before the other pending queues are served.
+ *
+ *  Define IRQ_NESTED for nested interrupts: irq_set_prio(<line>, <prio>)
+ *  before irq_enable() gives a line a priority 0..255, default 0, higher
+ *  preempts lower; out of range arguments are rejected with -1. While an
+ *  ISR runs, im only holds the lines of higher priority and IE is on.
+ *  Lines of equal priority are served lowest number first and never
+ *  preempt each other, so with all priorities equal nothing nests. ea is
+ *  saved on the stack by crt0, EIE by irq_process().
+ *  Worst case latency of the top priority line while a lower ISR runs:
+ *  the crt0 entry, _irq_entry up to its ISR call, plus the longest IE off
+ *  window of the lower ISR's irq_process(), i.e. from irq_disable() after
+ *  its queue is drained until irq_enable() before the next one is drained
+ *  (mask restore, ip clear and re-read, priority select, about 30
+ *  instructions), independent of the ISR's own run time.
+ *
+ *  Slow parts of a handler can be deferred to main(), see defer.h.
+ *
+ *  Define IRQ_AUTO_POP or IRQ_PACKED when the wb_irq_slave is built with
+ *  g_auto_pop or g_packed, this saves one or two bus accesses per message.
+ *
  *  @author Mathias Kreider <m.kreider@gsi.de>
  *
  *  @bug None!
@@ -50,14 +73,43 @@ typedef struct
    unsigned int  sel;
 } msi; 
 
-//ISR function pointer table
-typedef void (*isr_ptr_t)(void);
-isr_ptr_t isr_ptr_table[32]; 
+//max. messages handled per queue and pass, 0: until the queue is empty
+#ifndef IRQ_QUEUE_BATCH
+#define IRQ_QUEUE_BATCH 0
+#endif
+
+//queue read out, has to match the wb_irq_slave generics:
+//IRQ_AUTO_POP - g_auto_pop: reading the sel word pops the msg, no POP write
+//IRQ_PACKED   - g_packed as well: sel & adr in one word, 2 reads per msg.
+//               The adr is truncated to 32 - IRQ_PACKED_SEL_BITS bits
+#if defined(IRQ_PACKED) && !defined(IRQ_AUTO_POP)
+#define IRQ_AUTO_POP
+#endif
+#ifndef IRQ_PACKED_SEL_BITS
+#define IRQ_PACKED_SEL_BITS 4
+#endif
+#define IRQ_PACKED_SEL_SHIFT (32 - IRQ_PACKED_SEL_BITS)
+#define IRQ_PACKED_ADR_MASK  ((1u << IRQ_PACKED_SEL_SHIFT) - 1)
 
-//Global containing last processed MSI message
-volatile msi global_msi;
+//cycle accounting: define IRQ_CYCLES() as a free running cycle count, e.g.
+//a timer register or the cc CSR of a core built with CFG_CYCLE_COUNTER_ENABLED.
+//isr sums the time spent in irq_process() (with IRQ_NESTED the outer ISR
+//includes the nested ones), defer the time spent running deferred work.
+#ifdef IRQ_CYCLES
+typedef struct
+{
+   unsigned int isr;
+   unsigned int defer;
+} irq_acct_t;
 
-inline void irq_pop_msi( unsigned int irq_no);
+extern volatile irq_acct_t irq_acct;
+#endif
+
+//ISR function pointer table, the ISR gets the message it is called for
+typedef void (*isr_ptr_t)(msi* m);
+isr_ptr_t isr_ptr_table[32]; 
+
+inline void irq_pop_msi( unsigned int irq_no, msi* m);
 
 inline  unsigned int  irq_get_mask(void);
 
@@ -69,8 +121,14 @@ inline void irq_enable(void);
 
 inline void irq_clear( unsigned int mask);
 
+inline unsigned int irq_get_pending(void);
+
 inline void isr_table_clr(void);
 
 inline void irq_process(void);
 
+#ifdef IRQ_NESTED
+int  irq_set_prio( unsigned int irq_no, unsigned int prio);
+#endif
+
 #endif
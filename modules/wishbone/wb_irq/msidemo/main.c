@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include "display.h"
 #include "irq.h"
+#include "defer.h"
 
 volatile unsigned int* display = (unsigned int*)0x02900000;
 volatile unsigned int* irq_slave = (unsigned int*)0x02000d00;
@@ -24,35 +25,35 @@ char* mat_sprinthex(char* buffer, unsigned long val)
 	return buffer;	
 }
 
-void show_msi()
+void show_msi(msi* m)
 {
   char buffer[12];
   
-  mat_sprinthex(buffer, global_msi.msg);
+  mat_sprinthex(buffer, m->msg);
   disp_put_str("D ");
   disp_put_str(buffer);
   disp_put_c('\n');
 
   
-  mat_sprinthex(buffer, global_msi.src);
+  mat_sprinthex(buffer, m->src);
   disp_put_str("A ");
   disp_put_str(buffer);
   disp_put_c('\n');
 
   
-  mat_sprinthex(buffer, (unsigned long)global_msi.sel);
+  mat_sprinthex(buffer, (unsigned long)m->sel);
   disp_put_str("S ");
   disp_put_str(buffer);
   disp_put_c('\n');
 }
 
 
-void isr0()
+void isr0_work(msi* m)
 {
   unsigned int j;
   
   disp_put_str("ISR0\n");
-  show_msi();
+  show_msi(m);
  
  for (j = 0; j < 125000000; ++j) {
         asm("# noop"); /* no-op the compiler can't optimize away */
@@ -60,12 +61,17 @@ void isr0()
  disp_put_c('\f');     
 }
 
-void isr1()
+void isr0(msi* m)
+{
+  irq_defer(isr0_work, m); //the busy loop runs in main, interrupts on
+}
+
+void isr1(msi* m)
 {
   unsigned int j;
   
   disp_put_str("ISR1\n");
-  show_msi();
+  show_msi(m);
 
    for (j = 0; j < 125000000; ++j) {
         asm("# noop"); /* no-op the compiler can't optimize away */
@@ -74,12 +80,13 @@ void isr1()
 }
 
 void _irq_entry(void) {
+  int mode = disp_get_mode(); //main may be in the middle of a display access
   
   disp_put_c('\f');
   disp_put_str("IRQ_ENTRY\n");
   irq_process();
 
-   
+  disp_set_mode(mode);
 }
 
 const char mytext[] = "Hallo Welt!...\n\n";
@@ -89,6 +96,9 @@ void main(void) {
   isr_table_clr();
   isr_ptr_table[0]= isr0;
   isr_ptr_table[1]= isr1;  
+#ifdef IRQ_NESTED
+  irq_set_prio(1, 1); //ISR1 preempts ISR0's busy loop
+#endif
   irq_set_mask(0x03);
   irq_enable();
 
@@ -120,6 +130,7 @@ unsigned int time = 0;
 	addr_raw_off = 0;
 	
   while (1) {
+    irq_defer_run();
     /* Rotate the LEDs */
     
 
@@ -7,7 +7,9 @@ use work.wb_irq_pkg.all;
 entity wb_irq_lm32 is
 generic(g_msi_queues    : natural := 3;
         g_profile       : string;
-        g_reset_vector  : std_logic_vector(31 downto 0) := x"00000000"
+        g_reset_vector  : std_logic_vector(31 downto 0) := x"00000000";
+        g_msi_auto_pop  : boolean := false;  -- see wb_irq_slave g_auto_pop
+        g_msi_packed    : boolean := false   -- see wb_irq_slave g_packed
 );
 port(
    clk_sys_i      : in  std_logic;
@@ -36,7 +38,9 @@ begin
 
    msi_irq: wb_irq_slave 
    GENERIC MAP(g_queues       => g_msi_queues,
-               g_depth        => 8)
+               g_depth        => 8,
+               g_auto_pop     => g_msi_auto_pop,
+               g_packed       => g_msi_packed)
    PORT MAP (
       clk_i         => clk_sys_i,
       rst_n_i       => rst_n_i,  
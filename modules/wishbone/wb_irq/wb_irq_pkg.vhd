@@ -137,7 +137,9 @@ package wb_irq_pkg is
             g_depth   : natural := 8;
             g_datbits : natural := 32;
             g_adrbits : natural := 32;
-            g_selbits : natural := 4
+            g_selbits : natural := 4;
+            g_auto_pop: boolean := false;
+            g_packed  : boolean := false
   );
   port    (clk_i         : std_logic;
            rst_n_i       : std_logic; 
@@ -206,7 +208,9 @@ package wb_irq_pkg is
    component wb_irq_lm32 is
    generic( g_msi_queues    : natural := 3;
             g_profile       : string;
-            g_reset_vector  : std_logic_vector(31 downto 0) := x"00000000"
+            g_reset_vector  : std_logic_vector(31 downto 0) := x"00000000";
+            g_msi_auto_pop  : boolean := false;
+            g_msi_packed    : boolean := false
    );
    port(
       clk_sys_i      : in  std_logic;
@@ -34,7 +34,9 @@ entity wb_irq_slave is
             g_depth   : natural := 8;  -- queues depth
             g_datbits : natural := 32; -- data bits from irq wb to store
             g_adrbits : natural := 32; -- addr bits from irq wb to store 
-            g_selbits : natural := 4   -- sel  bits from irq wb to store
+            g_selbits : natural := 4;  -- sel  bits from irq wb to store
+            g_auto_pop: boolean := false; -- reading c_OFFS_POP of a queue pops its msg
+            g_packed  : boolean := false  -- c_OFFS_POP returns sel & adr in one word
   );
   port    (clk_i        : std_logic;
            rst_n_i      : std_logic; 
@@ -67,6 +69,9 @@ constant c_N_QUEUE    : natural := 16;
 constant c_OFFS_DATA  : natural := 0;             --ro wb data, msi message
 constant c_OFFS_ADDR  : natural := c_OFFS_DATA+4; --ro wb addr, msi adr low bits ID caller device
 constant c_OFFS_SEL   : natural := c_OFFS_ADDR+4; --ro wb sel,  
+constant c_OFFS_POP   : natural := c_OFFS_SEL+4;  --ro, only with g_auto_pop: wb sel, pops the msg on read
+                                                  --    with g_packed: sel in the upper g_selbits, adr below
+                                                  --    (adr truncated to 32-g_selbits bits)
 -------------------------------------------------------------------------
 function f_wb_wr(pval : std_logic_vector; ival : std_logic_vector; sel : std_logic_vector; mode : string := "owr") return std_logic_vector is
    variable n_sel     : std_logic_vector(pval'range);
@@ -97,7 +102,7 @@ signal r_status,
        r_pop,
        r_clr,
        r_ena : std_logic_vector(g_queues-1 downto 0);
-signal queue_offs : natural;
+signal queue_offs : integer;
 signal word_offs  : natural;
 signal adr        : unsigned(7 downto 0);
 
@@ -164,7 +169,7 @@ begin
   -------------------------------------------------------------------------
   ctrl_en     <= ctrL_slave_i.cyc and ctrl_slave_i.stb;
   adr         <= unsigned(ctrl_slave_i.adr(7 downto 2)) & "00";
-  queue_offs  <= to_integer(adr(adr'left downto 4)-1);
+  queue_offs  <= to_integer(adr(adr'left downto 4)) - c_QUEUES/c_N_QUEUE;
   word_offs   <= to_integer(adr(3 downto 0));
 
   ctrl_slave_o.rty    <= '0';
@@ -175,6 +180,7 @@ begin
     variable v_dat  : std_logic_vector(g_datbits-1 downto 0);
     variable v_adr  : std_logic_vector(g_adrbits-1 downto 0);  
     variable v_sel  : std_logic_vector(g_selbits-1 downto 0); 
+    variable v_pack : std_logic_vector(31 downto 0);
   
   begin
       if rising_edge(clk_i) then
@@ -206,7 +212,8 @@ begin
                   end case;
                else
                   case to_integer(adr) is
-                     when c_STATUS   => ctrl_slave_o.dat(r_status'range)   <= r_status;
+                     -- a pop in flight is not yet visible in r_status
+                     when c_STATUS   => ctrl_slave_o.dat(r_status'range)   <= r_status and not r_pop;
                      when c_ENA_GET  => ctrl_slave_o.dat(r_ena'range)      <= r_ena;
                      when others     => ctrl_slave_o.ack <= '0'; ctrl_slave_o.err <= '1';
                   end case;
@@ -221,6 +228,19 @@ begin
                   when c_OFFS_DATA =>  ctrl_slave_o.dat <= std_logic_vector(to_unsigned(0, 32-g_datbits)) & v_dat; 
                   when c_OFFS_ADDR =>  ctrl_slave_o.dat <= std_logic_vector(to_unsigned(0, 32-g_adrbits)) & v_adr;
                   when c_OFFS_SEL  =>  ctrl_slave_o.dat <= std_logic_vector(to_unsigned(0, 32-g_selbits)) & v_sel;
+                  when c_OFFS_POP  =>
+                    if(g_auto_pop) then
+                      if(g_packed) then
+                        v_pack := std_logic_vector(resize(unsigned(v_adr), 32));
+                        v_pack(31 downto 32-g_selbits) := v_sel;
+                        ctrl_slave_o.dat <= v_pack;
+                      else
+                        ctrl_slave_o.dat <= std_logic_vector(to_unsigned(0, 32-g_selbits)) & v_sel;
+                      end if;
+                      r_pop(queue_offs) <= '1';
+                    else
+                      ctrl_slave_o.ack <= '0'; ctrl_slave_o.err <= '1';
+                    end if;
                   when others =>  ctrl_slave_o.ack <= '0'; ctrl_slave_o.err <= '1';
                 end case;
               else
@@ -65,6 +65,8 @@ entity wb_simple_uart is
     wb_stall_o : out std_logic;
 
     int_o : out std_logic;
+    -- TX interrupt, level: TX FIFO empty (no FIFO: transmitter idle)
+    int_tx_o : out std_logic;
 
     uart_rxd_i : in  std_logic;
     uart_txd_o : out std_logic
@@ -316,6 +318,9 @@ begin  -- arch
     end process;
 
     regs_in.sr_tx_busy_i   <= tx_fifo_full;
+
+    int_o    <= not rx_fifo_empty;
+    int_tx_o <= tx_fifo_empty;
   end generate gen_phys_fifos;
 
   gen_phys_nofifos : if not g_WITH_PHYSICAL_UART_FIFO generate
@@ -323,6 +328,7 @@ begin  -- arch
     phys_tx_data <= regs_out.tdr_tx_data_o;
     phys_tx_start <= regs_out.tdr_tx_data_wr_o and not phys_tx_busy;
     regs_in.sr_tx_busy_i   <= phys_tx_busy when (g_WITH_PHYSICAL_UART) else '0';
+    int_tx_o               <= not phys_tx_busy when (g_WITH_PHYSICAL_UART) else '1';
 
     p_drive_rx_ready : process(clk_sys_i)
     begin
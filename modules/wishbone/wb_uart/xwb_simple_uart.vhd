@@ -57,6 +57,7 @@ entity xwb_simple_uart is
     slave_o : out t_wishbone_slave_out;
     desc_o  : out t_wishbone_device_descriptor;
     int_o   : out std_logic;
+    int_tx_o: out std_logic;
 
     uart_rxd_i : in  std_logic;
     uart_txd_o : out std_logic);
@@ -91,6 +92,7 @@ begin  -- arch
       wb_ack_o   => slave_o.ack,
       wb_stall_o => slave_o.stall,
       int_o      => int_o,
+      int_tx_o   => int_tx_o,
       uart_rxd_i => uart_rxd_i,
       uart_txd_o => uart_txd_o);
 
@@ -526,8 +526,8 @@ package wishbone_pkg is
       product     => (
         vendor_id => x"0000000000000651",  -- GSI
         device_id => x"cababa56",
-        version   => x"00000001",
-        date      => x"20120518",
+        version   => x"00000002",
+        date      => x"20261018",
         name      => "WB4-Streaming-DMA_0")));
   component xwb_dma is
     generic(
@@ -766,9 +766,10 @@ package wishbone_pkg is
 
   component xwb_i2c_master
     generic (
-      g_interface_mode      : t_wishbone_interface_mode      := CLASSIC;
-      g_address_granularity : t_wishbone_address_granularity := WORD;
-      g_num_interfaces      : integer := 1);
+      g_interface_mode         : t_wishbone_interface_mode      := CLASSIC;
+      g_address_granularity    : t_wishbone_address_granularity := WORD;
+      g_num_interfaces         : integer := 1;
+      g_independent_interfaces : boolean := false);
     port (
       clk_sys_i    : in  std_logic;
       rst_n_i      : in  std_logic;
@@ -948,6 +949,7 @@ package wishbone_pkg is
       wb_ack_o   : out std_logic;
       wb_stall_o : out std_logic;
       int_o      : out std_logic;
+      int_tx_o   : out std_logic;
       uart_rxd_i : in  std_logic := '1';
       uart_txd_o : out std_logic);
   end component;
@@ -972,6 +974,7 @@ package wishbone_pkg is
       slave_o    : out t_wishbone_slave_out;
       desc_o     : out t_wishbone_device_descriptor;
       int_o      : out std_logic;
+      int_tx_o   : out std_logic;
       uart_rxd_i : in  std_logic := '1';
       uart_txd_o : out std_logic);
   end component;
@@ -27,6 +27,7 @@
 #include <linux/version.h>
 #include <linux/spinlock.h>
 #include <linux/jiffies.h>
+#include <linux/workqueue.h>
 
 struct ocores_i2c;
 static int ohwr_i2c_mux_select(struct ocores_i2c *i2c, u32 num);
@@ -112,12 +113,72 @@ void i2c_mux_del_adapters(struct i2c_mux_core *muxc)
 }
 #endif
 
+#if KERNEL_VERSION(4, 8, 0) > LINUX_VERSION_CODE
+#define I2C_LOCK_ROOT_ADAPTER 0
+#define i2c_lock_bus(adap, flags) i2c_lock_adapter(adap)
+#define i2c_unlock_bus(adap, flags) i2c_unlock_adapter(adap)
+#endif
+
+static unsigned int ddm_cache_period_ms;
+module_param(ddm_cache_period_ms, uint, 0444);
+MODULE_PARM_DESC(ddm_cache_period_ms,
+		 "SFP DDM cache refresh period in ms (default 0: cache disabled)");
+
+static unsigned int ddm_cache_max_age_ms = 1000;
+module_param(ddm_cache_max_age_ms, uint, 0444);
+MODULE_PARM_DESC(ddm_cache_max_age_ms,
+		 "Maximum age in ms of SFP DDM data served from the cache (default 1000)");
 
 #define OCORES_FLAG_POLL BIT(0)
+#define OCORES_FLAG_ISR_OFF BIT(1) /* the ISR does not own the transfer */
+
+#define OCORES_DDM_NCHAN	2
+#define OCORES_DDM_PAGE_SIZE	256
+#define OCORES_DDM_ADDR_A0	0x50
+#define OCORES_DDM_ADDR_A2	0x51
+
+/**
+ * SFP management page (A0 or A2) as last read from the bus
+ * @stamp: jiffies of the last successful refresh
+ * @valid: data can be served
+ * @data: page content
+ */
+struct ocores_ddm_page {
+	unsigned long stamp;
+	bool valid;
+	u8 data[OCORES_DDM_PAGE_SIZE];
+};
+
+/* register access modes */
+enum ocores_io {
+	OCORES_IO_8 = 0,
+	OCORES_IO_16,
+	OCORES_IO_16BE,
+	OCORES_IO_32,
+	OCORES_IO_32BE,
+	OCORES_IO_GRLIB,
+};
+
+#define OCI2C_NUM_REGS		8
 
 /**
- * @process_lock: protect I2C transfer process.
- *     ocores_process() and ocores_process_timeout() can't run in parallel.
+ * @state: transfer state, see STATE_. During an IRQ driven transfer only
+ *     ocores_process() changes it: on timeout ocores_process_timeout()
+ *     takes the transfer over from the ISR (OCORES_FLAG_ISR_OFF) before
+ *     touching it, so the ISR does not need any lock.
+ * @io: register access mode
+ * @regs: address of every register
+ * @irq: interrupt line (when not polling)
+ * @nchan: number of independent channels of the device. The instances of
+ *     all the channels are allocated together, the first one is the
+ *     platform driver data.
+ * @chan: OHWR mux channel currently selected
+ * @ddm_chans: OHWR mux channels (bit 0 without mux) that carry SFP
+ *     modules, the only ones the DDM cache applies to
+ * @ddm_period: DDM cache refresh period in jiffies (0 when disabled)
+ * @ddm_max_age: DDM cache staleness bound in jiffies
+ * @ddm: DDM cache, A0 and A2 pages for each channel. Like any transfer,
+ *     it is protected by the (root) adapter bus lock.
  */
 struct ocores_i2c {
 	void __iomem *base;
@@ -130,13 +191,20 @@ struct ocores_i2c {
 	struct i2c_msg *msg;
 	int pos;
 	int nmsgs;
-	int state; /* see STATE_ */
-	spinlock_t process_lock;
+	int state;
 	struct clk *clk;
 	int ip_clock_khz;
 	int bus_clock_khz;
-	void (*setreg)(struct ocores_i2c *i2c, int reg, u8 value);
-	u8 (*getreg)(struct ocores_i2c *i2c, int reg);
+	enum ocores_io io;
+	void __iomem *regs[OCI2C_NUM_REGS];
+	int irq;
+	unsigned int nchan;
+	unsigned int chan;
+	u32 ddm_chans;
+	unsigned long ddm_period;
+	unsigned long ddm_max_age;
+	struct delayed_work ddm_work;
+	struct ocores_ddm_page ddm[OCORES_DDM_NCHAN][2];
 };
 
 /* registers */
@@ -169,6 +237,9 @@ struct ocores_i2c {
 #define OCI2C_OHWR_MUX_NUM_MASK 0x80
 #define OCI2C_OHWR_MUX_SEL_MASK 0x0F
 
+#define OCI2C_OHWR_CHAN_STRIDE	8 /* registers between independent channels */
+#define OCI2C_OHWR_MAX_CHANNELS	8
+
 #define STATE_DONE		0
 #define STATE_START		1
 #define STATE_WRITE		2
@@ -178,6 +249,7 @@ struct ocores_i2c {
 #define TYPE_OCORES		0
 #define TYPE_GRLIB		1
 #define TYPE_OHWR		2
+#define TYPE_OHWR_MULTI		3
 
 #undef I2C_8BIT_ADDR_FROM_MSG
 
@@ -255,89 +327,178 @@ int devm_request_any_context_irq(struct device *dev, unsigned int irq,
 }
 #endif
 
-static void oc_setreg_8(struct ocores_i2c *i2c, int reg, u8 value)
+static inline void oc_setreg_8(struct ocores_i2c *i2c, int reg, u8 value)
 {
-	iowrite8(value, i2c->base + (reg << i2c->reg_shift));
+	iowrite8(value, i2c->regs[reg]);
 }
 
-static void oc_setreg_16(struct ocores_i2c *i2c, int reg, u8 value)
+static inline void oc_setreg_16(struct ocores_i2c *i2c, int reg, u8 value)
 {
-	iowrite16(value, i2c->base + (reg << i2c->reg_shift));
+	iowrite16(value, i2c->regs[reg]);
 }
 
-static void oc_setreg_32(struct ocores_i2c *i2c, int reg, u8 value)
+static inline void oc_setreg_32(struct ocores_i2c *i2c, int reg, u8 value)
 {
-	iowrite32(value, i2c->base + (reg << i2c->reg_shift));
+	iowrite32(value, i2c->regs[reg]);
 }
 
-static void oc_setreg_16be(struct ocores_i2c *i2c, int reg, u8 value)
+static inline void oc_setreg_16be(struct ocores_i2c *i2c, int reg, u8 value)
 {
-	iowrite16be(value, i2c->base + (reg << i2c->reg_shift));
+	iowrite16be(value, i2c->regs[reg]);
 }
 
-static void oc_setreg_32be(struct ocores_i2c *i2c, int reg, u8 value)
+static inline void oc_setreg_32be(struct ocores_i2c *i2c, int reg, u8 value)
 {
-	iowrite32be(value, i2c->base + (reg << i2c->reg_shift));
+	iowrite32be(value, i2c->regs[reg]);
 }
 
 static inline u8 oc_getreg_8(struct ocores_i2c *i2c, int reg)
 {
-	return ioread8(i2c->base + (reg << i2c->reg_shift));
+	return ioread8(i2c->regs[reg]);
 }
 
 static inline u8 oc_getreg_16(struct ocores_i2c *i2c, int reg)
 {
-	return ioread16(i2c->base + (reg << i2c->reg_shift));
+	return ioread16(i2c->regs[reg]);
 }
 
 static inline u8 oc_getreg_32(struct ocores_i2c *i2c, int reg)
 {
-	return ioread32(i2c->base + (reg << i2c->reg_shift));
+	return ioread32(i2c->regs[reg]);
 }
 
 static inline u8 oc_getreg_16be(struct ocores_i2c *i2c, int reg)
 {
-	return ioread16be(i2c->base + (reg << i2c->reg_shift));
+	return ioread16be(i2c->regs[reg]);
 }
 
 static inline u8 oc_getreg_32be(struct ocores_i2c *i2c, int reg)
 {
-	return ioread32be(i2c->base + (reg << i2c->reg_shift));
+	return ioread32be(i2c->regs[reg]);
+}
+
+/*
+ * Read and write functions for the GRLIB port of the controller. Registers are
+ * 32-bit big endian and the PRELOW and PREHIGH registers are merged into one
+ * register. The subsequent registers have their offsets decreased accordingly
+ * (see ocores_init_regs()).
+ */
+static u8 oc_getreg_grlib(struct ocores_i2c *i2c, int reg)
+{
+	u32 rd;
+
+	rd = ioread32be(i2c->regs[reg]);
+	if (reg == OCI2C_PREHIGH)
+		return (u8)(rd >> 8);
+	else
+		return (u8)rd;
+}
+
+static void oc_setreg_grlib(struct ocores_i2c *i2c, int reg, u8 value)
+{
+	u32 curr, wr;
+
+	if (reg == OCI2C_PRELOW || reg == OCI2C_PREHIGH) {
+		curr = ioread32be(i2c->regs[reg]);
+		if (reg == OCI2C_PRELOW)
+			wr = (curr & 0xff00) | value;
+		else
+			wr = (((u32)value) << 8) | (curr & 0xff);
+	} else {
+		wr = value;
+	}
+	iowrite32be(wr, i2c->regs[reg]);
 }
 
-static inline void oc_setreg(struct ocores_i2c *i2c, int reg, u8 value)
+/*
+ * The access mode never changes after probe, so the switch is always
+ * predicted and, unlike a call through a function pointer, it does not
+ * go through an indirect branch (retpoline).
+ */
+static __always_inline void oc_setreg(struct ocores_i2c *i2c, int reg,
+				      u8 value)
 {
-	i2c->setreg(i2c, reg, value);
+	switch (i2c->io) {
+	case OCORES_IO_8:
+		oc_setreg_8(i2c, reg, value);
+		break;
+	case OCORES_IO_16:
+		oc_setreg_16(i2c, reg, value);
+		break;
+	case OCORES_IO_16BE:
+		oc_setreg_16be(i2c, reg, value);
+		break;
+	case OCORES_IO_32:
+		oc_setreg_32(i2c, reg, value);
+		break;
+	case OCORES_IO_32BE:
+		oc_setreg_32be(i2c, reg, value);
+		break;
+	case OCORES_IO_GRLIB:
+		oc_setreg_grlib(i2c, reg, value);
+		break;
+	}
 }
 
-static inline u8 oc_getreg(struct ocores_i2c *i2c, int reg)
+static __always_inline u8 oc_getreg(struct ocores_i2c *i2c, int reg)
 {
-	return i2c->getreg(i2c, reg);
+	switch (i2c->io) {
+	case OCORES_IO_8:
+		return oc_getreg_8(i2c, reg);
+	case OCORES_IO_16:
+		return oc_getreg_16(i2c, reg);
+	case OCORES_IO_16BE:
+		return oc_getreg_16be(i2c, reg);
+	case OCORES_IO_32:
+		return oc_getreg_32(i2c, reg);
+	case OCORES_IO_32BE:
+		return oc_getreg_32be(i2c, reg);
+	case OCORES_IO_GRLIB:
+		return oc_getreg_grlib(i2c, reg);
+	}
+	return 0;
 }
 
+/**
+ * Compute the address of every register
+ * @i2c: ocores I2C device instance
+ *
+ * Done once at probe time, so that an access does not need to shift the
+ * register index.
+ */
+static void ocores_init_regs(struct ocores_i2c *i2c)
+{
+	int reg, rreg;
+
+	for (reg = 0; reg < OCI2C_NUM_REGS; reg++) {
+		rreg = reg;
+		if (i2c->io == OCORES_IO_GRLIB && reg != OCI2C_PRELOW)
+			rreg--;
+		i2c->regs[reg] = i2c->base + (rreg << i2c->reg_shift);
+	}
+}
+
+/*
+ * It runs either from the ISR or from the polling loop, never both for the
+ * same transfer, and never together with ocores_process_timeout(): it does
+ * not need any lock.
+ */
 static void ocores_process(struct ocores_i2c *i2c, u8 stat)
 {
 	struct i2c_msg *msg = i2c->msg;
-	unsigned long flags;
-
-	/*
-	 * If we spin here is because we are in timeout, so we are going
-	 * to be in STATE_ERROR. See ocores_process_timeout()
-	 */
-	spin_lock_irqsave(&i2c->process_lock, flags);
 
 	if ((i2c->state == STATE_DONE) || (i2c->state == STATE_ERROR)) {
 		/* stop has been sent */
 		oc_setreg(i2c, OCI2C_CMD, OCI2C_CMD_IACK);
 		wake_up(&i2c->wait);
-		goto out;
+		return;
 	}
 
 	/* error? */
 	if (stat & OCI2C_STAT_ARBLOST) {
 		i2c->state = STATE_ERROR;
 		oc_setreg(i2c, OCI2C_CMD, OCI2C_CMD_STOP);
-		goto out;
+		return;
 	}
 
 	if ((i2c->state == STATE_START) || (i2c->state == STATE_WRITE)) {
@@ -347,7 +508,7 @@ static void ocores_process(struct ocores_i2c *i2c, u8 stat)
 		if (stat & OCI2C_STAT_NACK) {
 			i2c->state = STATE_ERROR;
 			oc_setreg(i2c, OCI2C_CMD, OCI2C_CMD_STOP);
-			goto out;
+			return;
 		}
 	} else {
 		msg->buf[i2c->pos++] = oc_getreg(i2c, OCI2C_DATA);
@@ -369,14 +530,14 @@ static void ocores_process(struct ocores_i2c *i2c, u8 stat)
 
 				oc_setreg(i2c, OCI2C_DATA, addr);
 				oc_setreg(i2c, OCI2C_CMD, OCI2C_CMD_START);
-				goto out;
+				return;
 			}
 			i2c->state = (msg->flags & I2C_M_RD)
 				? STATE_READ : STATE_WRITE;
 		} else {
 			i2c->state = STATE_DONE;
 			oc_setreg(i2c, OCI2C_CMD, OCI2C_CMD_STOP);
-			goto out;
+			return;
 		}
 	}
 
@@ -387,16 +548,22 @@ static void ocores_process(struct ocores_i2c *i2c, u8 stat)
 		oc_setreg(i2c, OCI2C_DATA, msg->buf[i2c->pos++]);
 		oc_setreg(i2c, OCI2C_CMD, OCI2C_CMD_WRITE);
 	}
-
-out:
-	spin_unlock_irqrestore(&i2c->process_lock, flags);
 }
 
 static irqreturn_t ocores_isr(int irq, void *dev_id)
 {
 	struct ocores_i2c *i2c = dev_id;
-	u8 stat = oc_getreg(i2c, OCI2C_STATUS);
+	u8 stat;
+
+	/*
+	 * Polled transfers and timed out transfers raise IF as well (with a
+	 * shared line we are called anyway): leave them to their owner. The
+	 * polling loop calls us with irq = -1.
+	 */
+	if (irq >= 0 && (READ_ONCE(i2c->flags) & OCORES_FLAG_ISR_OFF))
+		return IRQ_NONE;
 
+	stat = oc_getreg(i2c, OCI2C_STATUS);
 	if (!(stat & OCI2C_STAT_IF))
 		return IRQ_NONE;
 
@@ -405,18 +572,34 @@ static irqreturn_t ocores_isr(int irq, void *dev_id)
 	return IRQ_HANDLED;
 }
 
+static int ocores_wait(struct ocores_i2c *i2c,
+		       int reg, u8 mask, u8 val,
+		       unsigned int timeout_us);
+
 /**
  * Process timeout event
  * @i2c: ocores I2C device instance
+ *
+ * It takes the transfer over from the ISR: the IP interrupt is masked, the
+ * ISR is told to ignore this instance (the line may be shared) and any
+ * running ISR is waited for. Then the transfer can be stopped without
+ * racing with ocores_process(). It must run in process context.
  */
 static void ocores_process_timeout(struct ocores_i2c *i2c)
 {
-	unsigned long flags;
+	u8 ctrl;
+
+	WRITE_ONCE(i2c->flags, i2c->flags | OCORES_FLAG_ISR_OFF);
+	ctrl = oc_getreg(i2c, OCI2C_CONTROL);
+	oc_setreg(i2c, OCI2C_CONTROL, ctrl & ~OCI2C_CTRL_IEN);
+	synchronize_irq(i2c->irq);
 
-	spin_lock_irqsave(&i2c->process_lock, flags);
 	i2c->state = STATE_ERROR;
 	oc_setreg(i2c, OCI2C_CMD, OCI2C_CMD_STOP);
-	spin_unlock_irqrestore(&i2c->process_lock, flags);
+
+	/* nobody is going to ack the interrupt of the stop: do it here */
+	ocores_wait(i2c, OCI2C_STATUS, OCI2C_STAT_BUSY, 0, 1000);
+	oc_setreg(i2c, OCI2C_CMD, OCI2C_CMD_IACK);
 }
 
 /**
@@ -425,28 +608,30 @@ static void ocores_process_timeout(struct ocores_i2c *i2c)
  * @reg: register to query
  * @mask: bitmask to apply on register value
  * @val: expected result
- * @timeout: timeout in jiffies
+ * @timeout_us: timeout in micro-seconds
  *
  * Timeout is necessary to avoid to stay here forever when the chip
  * does not answer correctly.
  *
+ * The timeout is counted in busy-wait steps instead of jiffies, so that
+ * it is bounded also in atomic context where interrupts are disabled and
+ * jiffies do not move.
+ *
  * Return: 0 on success, -ETIMEDOUT on timeout
  */
 static int ocores_wait(struct ocores_i2c *i2c,
 		       int reg, u8 mask, u8 val,
-		       const unsigned long timeout)
+		       unsigned int timeout_us)
 {
-	unsigned long j;
-
-	j = jiffies + timeout;
 	while (1) {
 		u8 status = oc_getreg(i2c, reg);
 
 		if ((status & mask) == val)
 			break;
 
-		if (time_after(jiffies, j))
+		if (!timeout_us--)
 			return -ETIMEDOUT;
+		udelay(1);
 	}
 	return 0;
 }
@@ -481,7 +666,7 @@ static int ocores_poll_wait(struct ocores_i2c *i2c)
 	 * once we are here we expect to get the expected result immediately
 	 * so if after 1ms we timeout then something is broken.
 	 */
-	err = ocores_wait(i2c, OCI2C_STATUS, mask, 0, msecs_to_jiffies(1));
+	err = ocores_wait(i2c, OCI2C_STATUS, mask, 0, 1000);
 	if (err)
 		dev_warn(i2c->adap.dev.parent,
 			 "%s: STATUS timeout, bit 0x%x did not clear in 1ms\n",
@@ -525,10 +710,13 @@ static int ocores_xfer_core(struct ocores_i2c *i2c,
 	u8 ctrl;
 
 	ctrl = oc_getreg(i2c, OCI2C_CONTROL);
-	if (polling)
+	if (polling) {
+		WRITE_ONCE(i2c->flags, i2c->flags | OCORES_FLAG_ISR_OFF);
 		oc_setreg(i2c, OCI2C_CONTROL, ctrl & ~OCI2C_CTRL_IEN);
-	else
+	} else {
+		WRITE_ONCE(i2c->flags, i2c->flags & ~OCORES_FLAG_ISR_OFF);
 		oc_setreg(i2c, OCI2C_CONTROL, ctrl | OCI2C_CTRL_IEN);
+	}
 
 	i2c->msg = msgs;
 	i2c->pos = 0;
@@ -553,11 +741,236 @@ static int ocores_xfer_core(struct ocores_i2c *i2c,
 	return (i2c->state == STATE_DONE) ? num : -EIO;
 }
 
+static struct ocores_ddm_page *ocores_ddm_page(struct ocores_i2c *i2c,
+					       u16 addr)
+{
+	if (addr != OCORES_DDM_ADDR_A0 && addr != OCORES_DDM_ADDR_A2)
+		return NULL;
+	if (i2c->chan >= OCORES_DDM_NCHAN)
+		return NULL;
+	if (!(i2c->ddm_chans & BIT(i2c->chan)))
+		return NULL;
+	return &i2c->ddm[i2c->chan][addr - OCORES_DDM_ADDR_A0];
+}
+
+static bool ocores_ddm_fresh(struct ocores_i2c *i2c,
+			     struct ocores_ddm_page *page)
+{
+	return page->valid &&
+		time_before(jiffies, page->stamp + i2c->ddm_max_age);
+}
+
+/**
+ * It tells if the transfer is a SFP management read: a one byte offset
+ * write followed by a read within the same page.
+ */
+static bool ocores_ddm_cacheable(struct i2c_msg *msgs, int num)
+{
+	if (num != 2)
+		return false;
+	if (msgs[0].addr != msgs[1].addr)
+		return false;
+	if ((msgs[0].flags & ~I2C_M_STOP) || msgs[0].len != 1)
+		return false;
+	if ((msgs[1].flags & ~I2C_M_STOP) != I2C_M_RD)
+		return false;
+	return msgs[0].buf[0] + msgs[1].len <= OCORES_DDM_PAGE_SIZE;
+}
+
+/**
+ * Read a whole SFP management page into the cache
+ * @i2c: ocores I2C device instance
+ * @addr: page address (A0 or A2)
+ * @polling: use the polling path instead of the IRQ one
+ *
+ * The caller must hold the bus lock and the channel must be selected.
+ *
+ * Return: 0 on success, negative errno otherwise
+ */
+static int ocores_ddm_fill(struct ocores_i2c *i2c, u16 addr, bool polling)
+{
+	struct ocores_ddm_page *page = ocores_ddm_page(i2c, addr);
+	u8 offset = 0;
+	struct i2c_msg msgs[2] = {
+		{ .addr = addr, .flags = 0, .len = 1, .buf = &offset, },
+		{ .addr = addr, .flags = I2C_M_RD,
+		  .len = OCORES_DDM_PAGE_SIZE, .buf = page->data, },
+	};
+	int ret;
+
+	page->valid = false;
+	ret = ocores_xfer_core(i2c, msgs, 2, polling);
+	if (ret < 0)
+		return ret;
+	page->stamp = jiffies;
+	page->valid = true;
+
+	return 0;
+}
+
+/**
+ * Drop the cached pages a transfer writes data to
+ * @i2c: ocores I2C device instance
+ * @msgs: messages to transfer
+ * @num: number of messages
+ */
+static void ocores_ddm_invalidate(struct ocores_i2c *i2c,
+				  struct i2c_msg *msgs, int num)
+{
+	struct ocores_ddm_page *page;
+	int i;
+
+	for (i = 0; i < num; i++) {
+		if ((msgs[i].flags & I2C_M_RD) || msgs[i].len <= 1)
+			continue;
+		page = ocores_ddm_page(i2c, msgs[i].addr);
+		if (page)
+			page->valid = false;
+	}
+}
+
+/**
+ * Transfer messages, going through the DDM cache when enabled
+ * @i2c: ocores I2C device instance
+ * @msgs: messages to transfer
+ * @num: number of messages
+ * @polling: use the polling path instead of the IRQ one
+ *
+ * SFP management reads are served from memory while the cached page is
+ * younger than ddm_max_age. On a miss the whole page is read once: since
+ * the bus lock serializes the callers, all the readers waiting behind the
+ * first one are served from the page it has just read.
+ * Any data write to a management address drops the page.
+ *
+ * Return: number of transferred messages on success, negative errno otherwise
+ */
+static int ocores_xfer_msgs(struct ocores_i2c *i2c,
+			    struct i2c_msg *msgs, int num, bool polling)
+{
+	struct ocores_ddm_page *page;
+	int err;
+
+	if (!i2c->ddm_period)
+		return ocores_xfer_core(i2c, msgs, num, polling);
+
+	if (ocores_ddm_cacheable(msgs, num)) {
+		page = ocores_ddm_page(i2c, msgs[0].addr);
+		if (page) {
+			if (!ocores_ddm_fresh(i2c, page)) {
+				err = ocores_ddm_fill(i2c, msgs[0].addr,
+						      polling);
+				if (err)
+					return err;
+			}
+			memcpy(msgs[1].buf, &page->data[msgs[0].buf[0]],
+			       msgs[1].len);
+			return num;
+		}
+	}
+
+	ocores_ddm_invalidate(i2c, msgs, num);
+
+	return ocores_xfer_core(i2c, msgs, num, polling);
+}
+
+/**
+ * Transfer messages from atomic context, around the DDM cache
+ * @i2c: ocores I2C device instance
+ * @msgs: messages to transfer
+ * @num: number of messages
+ *
+ * A cache miss would read a whole page, tens of ms at 100 kHz with the
+ * interrupts off: the messages go to the bus as they are. Data writes
+ * still drop the cached page.
+ *
+ * Return: number of transferred messages on success, negative errno otherwise
+ */
+static int ocores_xfer_msgs_atomic(struct ocores_i2c *i2c,
+				   struct i2c_msg *msgs, int num)
+{
+	if (i2c->ddm_period)
+		ocores_ddm_invalidate(i2c, msgs, num);
+
+	return ocores_xfer_core(i2c, msgs, num, true);
+}
+
+/**
+ * Periodic DDM cache refresh
+ * @work: DDM work of an ocores I2C device instance
+ *
+ * It takes the bus lock and selects the channels by itself, like the
+ * mux core does before calling ocores_xfer().
+ */
+static void ocores_ddm_work(struct work_struct *work)
+{
+	struct ocores_i2c *i2c = container_of(to_delayed_work(work),
+					      struct ocores_i2c, ddm_work);
+	bool polling = i2c->flags & OCORES_FLAG_POLL;
+	unsigned int nchan = i2c->adap_mux ? i2c->adap_mux->max_adapters : 1;
+	unsigned int ch;
+
+	for (ch = 0; ch < nchan && ch < OCORES_DDM_NCHAN; ch++) {
+		if (!(i2c->ddm_chans & BIT(ch)))
+			continue;
+		i2c_lock_bus(&i2c->adap, I2C_LOCK_ROOT_ADAPTER);
+		if (i2c->adap_mux && ohwr_i2c_mux_select(i2c, ch)) {
+			i2c_unlock_bus(&i2c->adap, I2C_LOCK_ROOT_ADAPTER);
+			continue;
+		}
+		ocores_ddm_fill(i2c, OCORES_DDM_ADDR_A0, polling);
+		ocores_ddm_fill(i2c, OCORES_DDM_ADDR_A2, polling);
+		if (i2c->adap_mux)
+			ohwr_i2c_mux_deselect(i2c, ch);
+		i2c_unlock_bus(&i2c->adap, I2C_LOCK_ROOT_ADAPTER);
+	}
+
+	schedule_delayed_work(&i2c->ddm_work, i2c->ddm_period);
+}
+
+static void ocores_ddm_start(struct ocores_i2c *i2c)
+{
+	if (i2c->ddm_period)
+		schedule_delayed_work(&i2c->ddm_work, 0);
+}
+
+static void ocores_ddm_stop(struct ocores_i2c *i2c)
+{
+	int ch;
+
+	if (!i2c->ddm_period)
+		return;
+	cancel_delayed_work_sync(&i2c->ddm_work);
+	for (ch = 0; ch < OCORES_DDM_NCHAN; ch++) {
+		i2c->ddm[ch][0].valid = false;
+		i2c->ddm[ch][1].valid = false;
+	}
+}
+
 static int ocores_xfer_polling(struct i2c_adapter *adap,
 			       struct i2c_msg *msgs, int num)
 {
-	return ocores_xfer_core(i2c_get_adapdata(adap), msgs, num, true);
+	return ocores_xfer_msgs(i2c_get_adapdata(adap), msgs, num, true);
+}
+
+#if KERNEL_VERSION(5, 2, 0) <= LINUX_VERSION_CODE
+/**
+ * Transfer from atomic context (e.g. shutdown, IRQs disabled)
+ * @adap: I2C adapter
+ * @msgs: messages to transfer
+ * @num: number of messages
+ *
+ * It uses the polling path whatever the device configuration: it does
+ * not sleep, it does not allocate and every wait is bounded.
+ * The ISR leaves the device alone for the whole transfer.
+ *
+ * Return: number of transferred messages on success, negative errno otherwise
+ */
+static int ocores_xfer_atomic(struct i2c_adapter *adap,
+			      struct i2c_msg *msgs, int num)
+{
+	return ocores_xfer_msgs_atomic(i2c_get_adapdata(adap), msgs, num);
 }
+#endif
 
 static int ocores_xfer(struct i2c_adapter *adap,
 		       struct i2c_msg *msgs, int num)
@@ -566,9 +979,127 @@ static int ocores_xfer(struct i2c_adapter *adap,
 
 	if (i2c->flags & OCORES_FLAG_POLL)
 		return ocores_xfer_polling(adap, msgs, num);
-	return ocores_xfer_core(i2c, msgs, num, false);
+	return ocores_xfer_msgs(i2c, msgs, num, false);
+}
+
+/**
+ * Run an SMBus transaction directly on the ocores state machine
+ * @i2c: ocores I2C device instance
+ * @addr: 7bit slave address
+ * @flags: client flags
+ * @read_write: I2C_SMBUS_READ or I2C_SMBUS_WRITE
+ * @command: SMBus command (register) byte
+ * @size: SMBus transaction type
+ * @data: SMBus payload
+ * @polling: use the polling path instead of the IRQ one
+ * @atomic: called from atomic context, see ocores_xfer_msgs_atomic()
+ *
+ * Messages are built on the stack and read data lands directly in @data,
+ * so that there is no allocation nor intermediate copy. Transactions that
+ * are not handled here return -EOPNOTSUPP so that the I2C core falls back
+ * to the SMBus emulation on top of master_xfer.
+ *
+ * Return: 0 on success, negative errno otherwise
+ */
+static int ocores_smbus_xfer_core(struct ocores_i2c *i2c, u16 addr,
+				  unsigned short flags, char read_write,
+				  u8 command, int size,
+				  union i2c_smbus_data *data, bool polling,
+				  bool atomic)
+{
+	u8 wbuf[I2C_SMBUS_BLOCK_MAX + 1];
+	struct i2c_msg msgs[2] = {
+		{ .addr = addr, .flags = 0, .len = 1, .buf = wbuf, },
+		{ .addr = addr, .flags = I2C_M_RD, .len = 0, .buf = NULL, },
+	};
+	int num = 1;
+	int ret;
+
+	if (flags & (I2C_CLIENT_PEC | I2C_CLIENT_TEN))
+		return -EOPNOTSUPP;
+
+	wbuf[0] = command;
+	switch (size) {
+	case I2C_SMBUS_BYTE:
+		if (read_write == I2C_SMBUS_READ) {
+			msgs[0].flags = I2C_M_RD;
+			msgs[0].buf = &data->byte;
+		}
+		break;
+	case I2C_SMBUS_BYTE_DATA:
+		if (read_write == I2C_SMBUS_READ) {
+			msgs[1].len = 1;
+			msgs[1].buf = &data->byte;
+			num = 2;
+		} else {
+			wbuf[1] = data->byte;
+			msgs[0].len = 2;
+		}
+		break;
+	case I2C_SMBUS_WORD_DATA:
+		if (read_write == I2C_SMBUS_READ) {
+			msgs[1].len = 2;
+			msgs[1].buf = &wbuf[1];
+			num = 2;
+		} else {
+			wbuf[1] = data->word & 0xff;
+			wbuf[2] = data->word >> 8;
+			msgs[0].len = 3;
+		}
+		break;
+	case I2C_SMBUS_I2C_BLOCK_DATA:
+		if (data->block[0] == 0 || data->block[0] > I2C_SMBUS_BLOCK_MAX)
+			return -EINVAL;
+		if (read_write == I2C_SMBUS_READ) {
+			msgs[1].len = data->block[0];
+			msgs[1].buf = &data->block[1];
+			num = 2;
+		} else {
+			memcpy(&wbuf[1], &data->block[1], data->block[0]);
+			msgs[0].len = data->block[0] + 1;
+		}
+		break;
+	default:
+		return -EOPNOTSUPP;
+	}
+
+	if (atomic)
+		ret = ocores_xfer_msgs_atomic(i2c, msgs, num);
+	else
+		ret = ocores_xfer_msgs(i2c, msgs, num, polling);
+	if (ret < 0)
+		return ret;
+
+	if (size == I2C_SMBUS_WORD_DATA && read_write == I2C_SMBUS_READ)
+		data->word = wbuf[1] | (wbuf[2] << 8);
+
+	return 0;
 }
 
+static int ocores_smbus_xfer(struct i2c_adapter *adap, u16 addr,
+			     unsigned short flags, char read_write,
+			     u8 command, int size,
+			     union i2c_smbus_data *data)
+{
+	struct ocores_i2c *i2c = i2c_get_adapdata(adap);
+
+	return ocores_smbus_xfer_core(i2c, addr, flags, read_write,
+				      command, size, data,
+				      i2c->flags & OCORES_FLAG_POLL, false);
+}
+
+#if KERNEL_VERSION(5, 2, 0) <= LINUX_VERSION_CODE
+static int ocores_smbus_xfer_atomic(struct i2c_adapter *adap, u16 addr,
+				    unsigned short flags, char read_write,
+				    u8 command, int size,
+				    union i2c_smbus_data *data)
+{
+	return ocores_smbus_xfer_core(i2c_get_adapdata(adap), addr, flags,
+				      read_write, command, size, data, true,
+				      true);
+}
+#endif
+
 static int ocores_init(struct device *dev, struct ocores_i2c *i2c)
 {
 	int prescale;
@@ -608,6 +1139,13 @@ static u32 ocores_func(struct i2c_adapter *adap)
 
 static const struct i2c_algorithm ocores_algorithm = {
 	.master_xfer = ocores_xfer,
+#if KERNEL_VERSION(5, 2, 0) <= LINUX_VERSION_CODE
+	.master_xfer_atomic = ocores_xfer_atomic,
+#endif
+	.smbus_xfer = ocores_smbus_xfer,
+#if KERNEL_VERSION(5, 2, 0) <= LINUX_VERSION_CODE
+	.smbus_xfer_atomic = ocores_smbus_xfer_atomic,
+#endif
 	.functionality = ocores_func,
 };
 
@@ -635,6 +1173,10 @@ static const struct of_device_id ocores_i2c_match[] = {
 		.compatible = "ohwr,i2c-ohwr",
 		.data = (void *)TYPE_OHWR,
 	},
+	{
+		.compatible = "ohwr,i2c-ohwr-multi",
+		.data = (void *)TYPE_OHWR_MULTI,
+	},
 	{},
 };
 MODULE_DEVICE_TABLE(of, ocores_i2c_match);
@@ -658,6 +1200,10 @@ static const struct platform_device_id ocores_id_table[] = {
 		.name = "i2c-ohwr",
 		.driver_data = TYPE_OHWR,
 	},
+	{
+		.name = "i2c-ohwr-multi",
+		.driver_data = TYPE_OHWR_MULTI,
+	},
 	{},
 };
 MODULE_DEVICE_TABLE(id_table, ocores_id_table);
@@ -675,6 +1221,7 @@ static int ohwr_i2c_mux_select(struct ocores_i2c *i2c, u32 num)
 	mux |= (num & OCI2C_OHWR_MUX_SEL_MASK);
 	mux |= OCI2C_OHWR_MUX_BUSY;
 	oc_setreg(i2c, OCI2C_OHWR_MUX, mux);
+	i2c->chan = num;
 
 	return 0;
 }
@@ -754,44 +1301,6 @@ static void ocores_i2c_remove_ohwr(struct ocores_i2c *i2c)
 }
 
 #ifdef CONFIG_OF
-/*
- * Read and write functions for the GRLIB port of the controller. Registers are
- * 32-bit big endian and the PRELOW and PREHIGH registers are merged into one
- * register. The subsequent registers have their offsets decreased accordingly.
- */
-static u8 oc_getreg_grlib(struct ocores_i2c *i2c, int reg)
-{
-	u32 rd;
-	int rreg = reg;
-
-	if (reg != OCI2C_PRELOW)
-		rreg--;
-	rd = ioread32be(i2c->base + (rreg << i2c->reg_shift));
-	if (reg == OCI2C_PREHIGH)
-		return (u8)(rd >> 8);
-	else
-		return (u8)rd;
-}
-
-static void oc_setreg_grlib(struct ocores_i2c *i2c, int reg, u8 value)
-{
-	u32 curr, wr;
-	int rreg = reg;
-
-	if (reg != OCI2C_PRELOW)
-		rreg--;
-	if (reg == OCI2C_PRELOW || reg == OCI2C_PREHIGH) {
-		curr = ioread32be(i2c->base + (rreg << i2c->reg_shift));
-		if (reg == OCI2C_PRELOW)
-			wr = (curr & 0xff00) | value;
-		else
-			wr = (((u32)value) << 8) | (curr & 0xff);
-	} else {
-		wr = value;
-	}
-	iowrite32be(wr, i2c->base + (rreg << i2c->reg_shift));
-}
-
 static int ocores_i2c_of_probe(struct platform_device *pdev,
 				struct ocores_i2c *i2c)
 {
@@ -859,8 +1368,7 @@ static int ocores_i2c_of_probe(struct platform_device *pdev,
 	match = of_match_node(ocores_i2c_match, pdev->dev.of_node);
 	if (match && (long)match->data == TYPE_GRLIB) {
 		dev_dbg(&pdev->dev, "GRLIB variant of i2c-ocores\n");
-		i2c->setreg = oc_setreg_grlib;
-		i2c->getreg = oc_getreg_grlib;
+		i2c->io = OCORES_IO_GRLIB;
 	}
 
 	return 0;
@@ -869,20 +1377,176 @@ static int ocores_i2c_of_probe(struct platform_device *pdev,
 #define ocores_i2c_of_probe(pdev, i2c) -ENODEV
 #endif
 
+/**
+ * Variant of a device (TYPE_*)
+ * @pdev: platform device
+ *
+ * A device matched through DT has no platform_device_id, its variant
+ * comes from the compatible string.
+ */
+static long ocores_i2c_type(struct platform_device *pdev)
+{
+	const struct platform_device_id *id;
+	const struct of_device_id *match;
+
+	if (pdev->dev.of_node) {
+		match = of_match_node(ocores_i2c_match, pdev->dev.of_node);
+		return match ? (long)match->data : TYPE_OCORES;
+	}
+
+	id = platform_get_device_id(pdev);
+	return id ? id->driver_data : TYPE_OCORES;
+}
+
+/**
+ * Number of independent channels of a device
+ * @pdev: platform device
+ * @pdata: platform data, if any
+ *
+ * Only the OHWR variant built with independent interfaces has more than
+ * one channel: every channel has its own ocores register set, one after
+ * the other every OCI2C_OHWR_CHAN_STRIDE registers.
+ */
+static unsigned int ocores_i2c_num_channels(struct platform_device *pdev,
+				struct ocores_i2c_platform_data *pdata)
+{
+	u32 val = 1;
+
+	if (ocores_i2c_type(pdev) != TYPE_OHWR_MULTI)
+		return 1;
+
+	if (pdata)
+		val = pdata->num_channels;
+	else
+		of_property_read_u32(pdev->dev.of_node, "num-channels", &val);
+
+	return clamp_t(u32, val, 1, OCI2C_OHWR_MAX_CHANNELS);
+}
+
+/**
+ * Channels that carry SFP modules, for the DDM cache
+ * @pdev: platform device
+ * @pdata: platform data, if any
+ *
+ * Bit n is OHWR mux channel n, or independent channel n. Nothing is
+ * cached unless it is declared: 0x50 may as well be a plain EEPROM.
+ */
+static u32 ocores_i2c_sfp_channels(struct platform_device *pdev,
+				   struct ocores_i2c_platform_data *pdata)
+{
+	u32 val = 0;
+
+	if (pdata)
+		val = pdata->sfp_channels;
+	else
+		of_property_read_u32(pdev->dev.of_node, "sfp-channels", &val);
+
+	return val;
+}
+
+/**
+ * Initialize a channel and add its adapter to the I2C tree
+ * @pdev: platform device
+ * @i2c: ocores I2C device instance of the channel
+ * @irq: interrupt line, shared among the channels
+ *
+ * Return: 0 on success, negative errno otherwise
+ */
+static int ocores_i2c_add_channel(struct platform_device *pdev,
+				  struct ocores_i2c *i2c, int irq)
+{
+	int ret;
+
+	ocores_init_regs(i2c);
+	init_waitqueue_head(&i2c->wait);
+
+	if (!(i2c->flags & OCORES_FLAG_POLL)) {
+		ret = devm_request_any_context_irq(&pdev->dev, irq,
+						   ocores_isr,
+						   i2c->nchan > 1 ?
+						   IRQF_SHARED : 0,
+						   pdev->name, i2c);
+		if (ret < 0) {
+			dev_err(&pdev->dev, "Cannot claim IRQ\n");
+			return ret;
+		}
+	}
+
+	ret = ocores_init(&pdev->dev, i2c);
+	if (ret)
+		return ret;
+
+	/* hook up driver to tree */
+	i2c->adap = ocores_adapter;
+	i2c_set_adapdata(&i2c->adap, i2c);
+	i2c->adap.dev.parent = &pdev->dev;
+	i2c->adap.dev.of_node = pdev->dev.of_node;
+
+	/* add i2c adapter to i2c tree */
+	ret = i2c_add_adapter(&i2c->adap);
+	if (ret)
+		return ret;
+
+	if (ocores_i2c_type(pdev) == TYPE_OHWR) {
+		ret = ocores_i2c_probe_ohwr(i2c);
+		if (ret) {
+			i2c_del_adapter(&i2c->adap);
+			return ret;
+		}
+	}
+
+	if (ddm_cache_period_ms && i2c->ddm_chans) {
+		i2c->ddm_period = msecs_to_jiffies(ddm_cache_period_ms);
+		i2c->ddm_max_age = msecs_to_jiffies(ddm_cache_max_age_ms);
+		INIT_DELAYED_WORK(&i2c->ddm_work, ocores_ddm_work);
+		ocores_ddm_start(i2c);
+	}
+
+	return 0;
+}
+
+/**
+ * Remove a channel adapter from the I2C tree and disable the channel
+ * @pdev: platform device
+ * @i2c: ocores I2C device instance of the channel
+ */
+static void ocores_i2c_del_channel(struct platform_device *pdev,
+				   struct ocores_i2c *i2c)
+{
+	u8 ctrl;
+
+	ocores_ddm_stop(i2c);
+
+	ctrl = oc_getreg(i2c, OCI2C_CONTROL);
+	/* disable i2c logic */
+	ctrl &= ~(OCI2C_CTRL_EN | OCI2C_CTRL_IEN);
+	oc_setreg(i2c, OCI2C_CONTROL, ctrl);
+
+	if (ocores_i2c_type(pdev) == TYPE_OHWR)
+		ocores_i2c_remove_ohwr(i2c);
+
+	/* remove adapter & data */
+	i2c_del_adapter(&i2c->adap);
+}
+
 static int ocores_i2c_probe(struct platform_device *pdev)
 {
 	struct ocores_i2c *i2c;
 	struct ocores_i2c_platform_data *pdata;
 	struct resource *res;
+	unsigned int nchan, ch;
+	u32 sfp;
 	int irq;
 	int ret;
 	int i;
 
-	i2c = devm_kzalloc(&pdev->dev, sizeof(*i2c), GFP_KERNEL);
+	pdata = dev_get_platdata(&pdev->dev);
+	nchan = ocores_i2c_num_channels(pdev, pdata);
+
+	i2c = devm_kzalloc(&pdev->dev, sizeof(*i2c) * nchan, GFP_KERNEL);
 	if (!i2c)
 		return -ENOMEM;
-
-	spin_lock_init(&i2c->process_lock);
+	i2c->nchan = nchan;
 
 	res = platform_get_resource(pdev, IORESOURCE_MEM, 0);
 #if KERNEL_VERSION(3, 9, 0) > LINUX_VERSION_CODE
@@ -895,7 +1559,6 @@ static int ocores_i2c_probe(struct platform_device *pdev)
 		return PTR_ERR(i2c->base);
 #endif
 
-	pdata = dev_get_platdata(&pdev->dev);
 	if (pdata) {
 		i2c->reg_shift = pdata->reg_shift;
 		i2c->reg_io_width = pdata->reg_io_width;
@@ -910,24 +1573,21 @@ static int ocores_i2c_probe(struct platform_device *pdev)
 	if (i2c->reg_io_width == 0)
 		i2c->reg_io_width = 1; /* Set to default value */
 
-	if (!i2c->setreg || !i2c->getreg) {
+	if (i2c->io != OCORES_IO_GRLIB) {
 		bool be = pdata ? pdata->big_endian :
 			of_device_is_big_endian(pdev->dev.of_node);
 
 		switch (i2c->reg_io_width) {
 		case 1:
-			i2c->setreg = oc_setreg_8;
-			i2c->getreg = oc_getreg_8;
+			i2c->io = OCORES_IO_8;
 			break;
 
 		case 2:
-			i2c->setreg = be ? oc_setreg_16be : oc_setreg_16;
-			i2c->getreg = be ? oc_getreg_16be : oc_getreg_16;
+			i2c->io = be ? OCORES_IO_16BE : OCORES_IO_16;
 			break;
 
 		case 4:
-			i2c->setreg = be ? oc_setreg_32be : oc_setreg_32;
-			i2c->getreg = be ? oc_getreg_32be : oc_getreg_32;
+			i2c->io = be ? OCORES_IO_32BE : OCORES_IO_32;
 			break;
 
 		default:
@@ -938,8 +1598,6 @@ static int ocores_i2c_probe(struct platform_device *pdev)
 		}
 	}
 
-	init_waitqueue_head(&i2c->wait);
-
 	irq = platform_get_irq(pdev, 0);
 	if (irq == -ENXIO) {
 		i2c->flags |= OCORES_FLAG_POLL;
@@ -947,37 +1605,25 @@ static int ocores_i2c_probe(struct platform_device *pdev)
 		if (irq < 0)
 			return irq;
 	}
+	i2c->irq = irq;
 
-	if (!(i2c->flags & OCORES_FLAG_POLL)) {
-		ret = devm_request_any_context_irq(&pdev->dev, irq,
-						   ocores_isr, 0,
-						   pdev->name, i2c);
-		if (ret < 0) {
-			dev_err(&pdev->dev, "Cannot claim IRQ\n");
-			goto err_clk;
-		}
+	/* channels differ only by their register set */
+	for (ch = 1; ch < nchan; ch++) {
+		i2c[ch] = i2c[0];
+		i2c[ch].base += (OCI2C_OHWR_CHAN_STRIDE * ch) << i2c->reg_shift;
 	}
 
-	ret = ocores_init(&pdev->dev, i2c);
-	if (ret)
-		goto err_clk;
+	/* an independent channel has no mux: its own bit becomes bit 0 */
+	sfp = ocores_i2c_sfp_channels(pdev, pdata);
+	for (ch = 0; ch < nchan; ch++)
+		i2c[ch].ddm_chans = nchan > 1 ? (sfp >> ch) & 1 : sfp;
 
-	/* hook up driver to tree */
 	platform_set_drvdata(pdev, i2c);
-	i2c->adap = ocores_adapter;
-	i2c_set_adapdata(&i2c->adap, i2c);
-	i2c->adap.dev.parent = &pdev->dev;
-	i2c->adap.dev.of_node = pdev->dev.of_node;
-
-	/* add i2c adapter to i2c tree */
-	ret = i2c_add_adapter(&i2c->adap);
-	if (ret)
-		goto err_clk;
-
-	if (platform_get_device_id(pdev)->driver_data == TYPE_OHWR)
-		ret = ocores_i2c_probe_ohwr(i2c);
-	if (ret)
-		goto err_ohwr;
+	for (ch = 0; ch < nchan; ch++) {
+		ret = ocores_i2c_add_channel(pdev, &i2c[ch], irq);
+		if (ret)
+			goto err_chan;
+	}
 
 	/* add in known devices to the bus */
 	if (pdata) {
@@ -991,8 +1637,9 @@ static int ocores_i2c_probe(struct platform_device *pdev)
 
 	return 0;
 
-err_ohwr:
-	i2c_del_adapter(&i2c->adap);
+err_chan:
+	while (ch--)
+		ocores_i2c_del_channel(pdev, &i2c[ch]);
 err_clk:
 	clk_disable_unprepare(i2c->clk);
 	return ret;
@@ -1001,17 +1648,10 @@ err_clk:
 static int ocores_i2c_remove(struct platform_device *pdev)
 {
 	struct ocores_i2c *i2c = platform_get_drvdata(pdev);
-	u8 ctrl = oc_getreg(i2c, OCI2C_CONTROL);
+	unsigned int ch;
 
-	/* disable i2c logic */
-	ctrl &= ~(OCI2C_CTRL_EN | OCI2C_CTRL_IEN);
-	oc_setreg(i2c, OCI2C_CONTROL, ctrl);
-
-	if (platform_get_device_id(pdev)->driver_data == TYPE_OHWR)
-		ocores_i2c_remove_ohwr(i2c);
-
-	/* remove adapter & data */
-	i2c_del_adapter(&i2c->adap);
+	for (ch = i2c->nchan; ch--;)
+		ocores_i2c_del_channel(pdev, &i2c[ch]);
 
 	if (!IS_ERR(i2c->clk))
 		clk_disable_unprepare(i2c->clk);
@@ -1023,11 +1663,17 @@ static int ocores_i2c_remove(struct platform_device *pdev)
 static int ocores_i2c_suspend(struct device *dev)
 {
 	struct ocores_i2c *i2c = dev_get_drvdata(dev);
-	u8 ctrl = oc_getreg(i2c, OCI2C_CONTROL);
+	unsigned int ch;
+	u8 ctrl;
 
-	/* make sure the device is disabled */
-	ctrl &= ~(OCI2C_CTRL_EN | OCI2C_CTRL_IEN);
-	oc_setreg(i2c, OCI2C_CONTROL, ctrl);
+	for (ch = 0; ch < i2c->nchan; ch++) {
+		ocores_ddm_stop(&i2c[ch]);
+
+		ctrl = oc_getreg(&i2c[ch], OCI2C_CONTROL);
+		/* make sure the device is disabled */
+		ctrl &= ~(OCI2C_CTRL_EN | OCI2C_CTRL_IEN);
+		oc_setreg(&i2c[ch], OCI2C_CONTROL, ctrl);
+	}
 
 	if (!IS_ERR(i2c->clk))
 		clk_disable_unprepare(i2c->clk);
@@ -1037,21 +1683,31 @@ static int ocores_i2c_suspend(struct device *dev)
 static int ocores_i2c_resume(struct device *dev)
 {
 	struct ocores_i2c *i2c = dev_get_drvdata(dev);
+	unsigned long rate = 0;
+	unsigned int ch;
+	int ret;
 
 	if (!IS_ERR(i2c->clk)) {
-		unsigned long rate;
-		int ret = clk_prepare_enable(i2c->clk);
-
+		ret = clk_prepare_enable(i2c->clk);
 		if (ret) {
 			dev_err(dev,
 				"clk_prepare_enable failed: %d\n", ret);
 			return ret;
 		}
 		rate = clk_get_rate(i2c->clk) / 1000;
+	}
+
+	for (ch = 0; ch < i2c->nchan; ch++) {
 		if (rate)
-			i2c->ip_clock_khz = rate;
+			i2c[ch].ip_clock_khz = rate;
+		ret = ocores_init(dev, &i2c[ch]);
+		if (ret)
+			return ret;
+
+		ocores_ddm_start(&i2c[ch]);
 	}
-	return ocores_init(dev, i2c);
+
+	return 0;
 }
 
 static SIMPLE_DEV_PM_OPS(ocores_i2c_pm, ocores_i2c_suspend, ocores_i2c_resume);
@@ -15,6 +15,8 @@ struct ocores_i2c_platform_data {
 	bool big_endian; /* registers are big endian */
 	u8 num_devices; /* number of devices in the devices list */
 	struct i2c_board_info const *devices; /* devices connected to the bus */
+	u8 num_channels; /* independent channels (i2c-ohwr-multi only) */
+	u32 sfp_channels; /* channels with SFP modules, for the DDM cache */
 };
 
 #endif /* _LINUX_I2C_OCORES_H */
@@ -0,0 +1,801 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+/*
+ * Copyright (c) 2026 CERN
+ *
+ * SDB/xwb_metadata enumeration and its cache, see sdb-scan.h.
+ *
+ * Over a PCIe or VME bridge every register read is a round trip, so the
+ * scanner reads each ROM with as few calls as possible: the interconnect
+ * record first, for the record count, then all the remaining records in a
+ * single read. The result is a flat table of entries with absolute
+ * addresses and a hash index on vendor:device; instances of the same
+ * vendor:device are chained in scan order.
+ *
+ * The cache is the table written out as it is in memory, named after the
+ * source ID of the bitstream. It is only meant to be read back on the
+ * same host: the header records the layout version and entry size, and
+ * any mismatch makes the load fail so the caller scans again.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <byteswap.h>
+#include <endian.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "sdb-scan.h"
+
+#define SDB_RECORD_WORDS	(SDB_RECORD_SIZE / 4)
+
+/* More records than that in one ROM means we are not reading an SDB ROM */
+#define SDB_MAX_RECORDS		4096
+
+/* xwb_metadata layout, in words */
+#define META_VENDOR		0
+#define META_DEVICE		1
+#define META_VERSION		2
+#define META_BOM		3
+#define META_SOURCEID		4
+#define META_CAPS		8
+#define META_WORDS		9
+#define META_BOM_VALUE		0xfffe0000
+#define META_BOM_SWAPPED	0x0000feff
+#define META_SIZE		0x40
+
+#define CACHE_MAGIC		0x53444263	/* "SDBc" */
+#define CACHE_VERSION		1
+#define CACHE_SUFFIX		".sdb"
+
+struct cache_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entry_size;
+	uint32_t n;
+	uint64_t rom_addr;
+	struct sdb_synthesis syn;
+};
+
+/* -------------------------------------------------------------------- */
+/* Record decoding. The bus words are big endian SDB fields.            */
+/* -------------------------------------------------------------------- */
+
+static void words_to_bytes(uint8_t *b, const uint32_t *w, unsigned int n)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		b[4 * i + 0] = w[i] >> 24;
+		b[4 * i + 1] = w[i] >> 16;
+		b[4 * i + 2] = w[i] >> 8;
+		b[4 * i + 3] = w[i];
+	}
+}
+
+static uint16_t get16(const uint8_t *b)
+{
+	return b[0] << 8 | b[1];
+}
+
+static uint32_t get32(const uint8_t *b)
+{
+	return (uint32_t)b[0] << 24 | b[1] << 16 | b[2] << 8 | b[3];
+}
+
+static uint64_t get64(const uint8_t *b)
+{
+	return (uint64_t)get32(b) << 32 | get32(b + 4);
+}
+
+/* Copy a blank padded SDB string and cut the padding */
+static void get_string(char *dst, const uint8_t *src, size_t len)
+{
+	memcpy(dst, src, len);
+	dst[len] = '\0';
+	while (len && (dst[len - 1] == ' ' || dst[len - 1] == '\0'))
+		dst[--len] = '\0';
+}
+
+/* Product at b (vendor_id at b[0], name up to b[0x1a]) */
+static void get_product(struct sdb_entry *e, const uint8_t *b)
+{
+	e->vendor_id = get64(b);
+	e->device_id = get32(b + 0x08);
+	e->version = get32(b + 0x0c);
+	e->date = get32(b + 0x10);
+	get_string(e->name, b + 0x14, 19);
+}
+
+/* -------------------------------------------------------------------- */
+/* Table and index                                                      */
+/* -------------------------------------------------------------------- */
+
+void sdb_table_init(struct sdb_table *t)
+{
+	memset(t, 0, sizeof(*t));
+}
+
+void sdb_table_free(struct sdb_table *t)
+{
+	free(t->entries);
+	free(t->hash);
+	sdb_table_init(t);
+}
+
+static unsigned int hash_id(uint64_t vendor_id, uint32_t device_id,
+			    unsigned int size)
+{
+	uint64_t h = (vendor_id ^ ((uint64_t)device_id << 17) ^ device_id) *
+		     0x9e3779b97f4a7c15ULL;
+
+	return (h >> 32) & (size - 1);
+}
+
+/* Slot of vendor:device: its chain head, or the empty slot for it */
+static int32_t *hash_slot(const struct sdb_table *t, uint64_t vendor_id,
+			  uint32_t device_id)
+{
+	unsigned int i = hash_id(vendor_id, device_id, t->hash_size);
+	const struct sdb_entry *e;
+
+	for (;; i = (i + 1) & (t->hash_size - 1)) {
+		if (t->hash[i] < 0)
+			return &t->hash[i];
+		e = &t->entries[t->hash[i]];
+		if (e->vendor_id == vendor_id && e->device_id == device_id)
+			return &t->hash[i];
+	}
+}
+
+static void index_entry(struct sdb_table *t, int32_t idx)
+{
+	struct sdb_entry *e = &t->entries[idx];
+	int32_t *slot = hash_slot(t, e->vendor_id, e->device_id);
+
+	e->next = -1;
+	if (*slot < 0) {
+		*slot = idx;
+		return;
+	}
+	for (e = &t->entries[*slot]; e->next >= 0; e = &t->entries[e->next])
+		;
+	e->next = idx;
+}
+
+/* (Re)build the index with room for at least n entries */
+static int index_build(struct sdb_table *t, unsigned int n)
+{
+	unsigned int size = 16, i;
+	int32_t *hash;
+
+	while (size < 2 * n)
+		size <<= 1;
+	if (size <= t->hash_size)
+		return 0;
+	hash = malloc(size * sizeof(*hash));
+	if (!hash)
+		return -1;
+	memset(hash, 0xff, size * sizeof(*hash));
+	free(t->hash);
+	t->hash = hash;
+	t->hash_size = size;
+	for (i = 0; i < t->n; i++)
+		index_entry(t, i);
+	return 0;
+}
+
+static struct sdb_entry *table_add(struct sdb_table *t)
+{
+	struct sdb_entry *e;
+
+	if (t->n == t->size) {
+		unsigned int size = t->size ? 2 * t->size : 64;
+
+		e = realloc(t->entries, size * sizeof(*e));
+		if (!e)
+			return NULL;
+		t->entries = e;
+		t->size = size;
+	}
+	if (index_build(t, t->n + 1))
+		return NULL;
+	e = &t->entries[t->n++];
+	memset(e, 0, sizeof(*e));
+	return e;
+}
+
+/* Call once the entry returned by table_add() is filled in */
+static void table_commit(struct sdb_table *t, struct sdb_entry *e)
+{
+	index_entry(t, e - t->entries);
+}
+
+const struct sdb_entry *sdb_find(const struct sdb_table *t,
+				 uint64_t vendor_id, uint32_t device_id,
+				 unsigned int inst)
+{
+	const struct sdb_entry *e;
+	int32_t idx;
+
+	if (!t->hash_size)
+		return NULL;
+	idx = *hash_slot(t, vendor_id, device_id);
+	if (idx < 0)
+		return NULL;
+	for (e = &t->entries[idx]; inst; inst--) {
+		if (e->next < 0)
+			return NULL;
+		e = &t->entries[e->next];
+	}
+	return e;
+}
+
+const struct sdb_entry *sdb_find_next(const struct sdb_table *t,
+				      const struct sdb_entry *e)
+{
+	return e->next < 0 ? NULL : &t->entries[e->next];
+}
+
+/* -------------------------------------------------------------------- */
+/* SDB walk                                                             */
+/* -------------------------------------------------------------------- */
+
+static int bus_read(struct sdb_table *t, struct sdb_bus *bus, uint64_t addr,
+		    uint32_t *words, unsigned int n)
+{
+	t->bus_reads++;
+	return bus->read(bus, addr, words, n);
+}
+
+static void get_synthesis(struct sdb_table *t, const uint8_t *b)
+{
+	struct sdb_synthesis *s = &t->syn;
+
+	get_string(s->module_name, b, 16);
+	memcpy(s->commit_id, b + 0x10, 16);
+	get_string(s->tool_name, b + 0x20, 8);
+	s->tool_version = get32(b + 0x28);
+	s->date = get32(b + 0x2c);
+	get_string(s->user_name, b + 0x30, 15);
+	t->have_id = 1;
+}
+
+/* Read the whole ROM at rom (absolute) into a malloc'ed byte buffer */
+static uint8_t *read_rom(struct sdb_table *t, struct sdb_bus *bus,
+			 uint64_t rom, unsigned int *records)
+{
+	uint32_t hdr[SDB_RECORD_WORDS], *w;
+	uint8_t *b;
+	unsigned int n;
+
+	if (bus_read(t, bus, rom, hdr, SDB_RECORD_WORDS))
+		return NULL;
+	n = hdr[1] >> 16;
+	if (hdr[0] != SDB_MAGIC || (hdr[15] & 0xff) != SDB_RECORD_INTERCONNECT ||
+	    !n || n > SDB_MAX_RECORDS) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	w = malloc(n * SDB_RECORD_SIZE);
+	b = malloc(n * SDB_RECORD_SIZE);
+	if (!w || !b)
+		goto fail;
+	memcpy(w, hdr, sizeof(hdr));
+	if (n > 1 && bus_read(t, bus, rom + SDB_RECORD_SIZE,
+			      w + SDB_RECORD_WORDS,
+			      (n - 1) * SDB_RECORD_WORDS))
+		goto fail;
+	words_to_bytes(b, w, n * SDB_RECORD_WORDS);
+	free(w);
+	*records = n;
+	return b;
+
+fail:
+	free(w);
+	free(b);
+	return NULL;
+}
+
+/*
+ * Scan the ROM at rom. Below a bridge, base is where the bridge window
+ * starts, which is where the child bus' addr_first (interconnect record)
+ * appears. With id_only, just look for the synthesis and repository
+ * records.
+ */
+static int scan_bus(struct sdb_table *t, struct sdb_bus *bus, uint64_t rom,
+		    uint64_t base, unsigned int depth, int id_only)
+{
+	struct sdb_entry *e;
+	unsigned int n, i;
+	uint8_t *b, *r;
+	int ret = 0;
+
+	if (depth >= SDB_MAX_DEPTH) {
+		errno = ELOOP;
+		return -1;
+	}
+	b = read_rom(t, bus, rom, &n);
+	if (!b)
+		return -1;
+	if (depth)
+		base -= get64(b + 0x08);
+
+	for (i = 1; i < n && !ret; i++) {
+		r = b + i * SDB_RECORD_SIZE;
+
+		switch (r[SDB_RECORD_SIZE - 1]) {
+		case SDB_RECORD_SYNTHESIS:
+			if (!t->have_id || depth == 0)
+				get_synthesis(t, r);
+			continue;
+		case SDB_RECORD_REPO_URL:
+			if (depth == 0)
+				get_string(t->syn.repo_url, r, 63);
+			continue;
+		case SDB_RECORD_DEVICE:
+		case SDB_RECORD_BRIDGE:
+		case SDB_RECORD_MSI:
+		case SDB_RECORD_INTEGRATION:
+			if (id_only)
+				continue;
+			break;
+		default:
+			continue;
+		}
+
+		e = table_add(t);
+		if (!e) {
+			ret = -1;
+			break;
+		}
+		e->record_type = r[SDB_RECORD_SIZE - 1];
+		e->depth = depth;
+		if (e->record_type == SDB_RECORD_INTEGRATION) {
+			get_product(e, r + 0x18);
+			table_commit(t, e);
+			continue;
+		}
+		e->addr_first = base + get64(r + 0x08);
+		e->addr_last = base + get64(r + 0x10);
+		get_product(e, r + 0x18);
+		if (e->record_type != SDB_RECORD_BRIDGE) {
+			e->abi_class = get16(r);
+			e->abi_ver_major = r[2];
+			e->abi_ver_minor = r[3];
+			e->bus_specific = get32(r + 4);
+		}
+		table_commit(t, e);
+
+		if (e->record_type == SDB_RECORD_BRIDGE) {
+			uint64_t child = base + get64(r);
+			uint64_t first = e->addr_first;
+
+			/* e may move when the table grows */
+			ret = scan_bus(t, bus, child, first, depth + 1, 0);
+		}
+	}
+
+	free(b);
+	return ret;
+}
+
+int sdb_scan(struct sdb_table *t, struct sdb_bus *bus, uint64_t rom_addr)
+{
+	t->rom_addr = rom_addr;
+	return scan_bus(t, bus, rom_addr, 0, 0, 0);
+}
+
+int sdb_read_id(struct sdb_table *t, struct sdb_bus *bus, uint64_t rom_addr)
+{
+	t->rom_addr = rom_addr;
+	if (scan_bus(t, bus, rom_addr, 0, 0, 1))
+		return -1;
+	if (!t->have_id) {
+		errno = ENOENT;
+		return -1;
+	}
+	return 0;
+}
+
+/* -------------------------------------------------------------------- */
+/* xwb_metadata                                                         */
+/* -------------------------------------------------------------------- */
+
+/* Check the BOM of w[] (META_BOM at w[bom]) and fix the byte order */
+static int meta_fix_order(uint32_t *w, unsigned int n, unsigned int bom)
+{
+	unsigned int i;
+
+	if (w[bom] == META_BOM_VALUE)
+		return 0;
+	if (w[bom] != META_BOM_SWAPPED) {
+		errno = EINVAL;
+		return -1;
+	}
+	for (i = 0; i < n; i++)
+		w[i] = bswap_32(w[i]);
+	return 0;
+}
+
+static void meta_id(uint8_t id[16], const uint32_t *w)
+{
+	words_to_bytes(id, w, 4);
+}
+
+int sdb_read_metadata_id(struct sdb_bus *bus, uint64_t addr, uint8_t id[16])
+{
+	uint32_t w[5];
+
+	if (bus->read(bus, addr + 4 * META_BOM, w, 5) ||
+	    meta_fix_order(w, 5, 0))
+		return -1;
+	meta_id(id, w + 1);
+	return 0;
+}
+
+int sdb_add_metadata(struct sdb_table *t, struct sdb_bus *bus, uint64_t addr)
+{
+	uint32_t w[META_WORDS];
+	struct sdb_entry *e;
+	uint8_t id[16];
+
+	if (bus_read(t, bus, addr, w, META_WORDS) ||
+	    meta_fix_order(w, META_WORDS, META_BOM))
+		return -1;
+
+	e = table_add(t);
+	if (!e)
+		return -1;
+	e->vendor_id = w[META_VENDOR];
+	e->device_id = w[META_DEVICE];
+	e->version = w[META_VERSION];
+	e->bus_specific = w[META_CAPS];
+	e->addr_first = addr;
+	e->addr_last = addr + META_SIZE - 1;
+	e->record_type = SDB_RECORD_DEVICE;
+	e->flags = SDB_ENTRY_METADATA;
+	table_commit(t, e);
+
+	meta_id(id, w + META_SOURCEID);
+	if (!t->have_id && sdb_id_cacheable(id)) {
+		memcpy(t->syn.commit_id, id, 16);
+		t->have_id = 1;
+	}
+	return 0;
+}
+
+/* -------------------------------------------------------------------- */
+/* IDs and cache                                                        */
+/* -------------------------------------------------------------------- */
+
+int sdb_id_cacheable(const uint8_t id[16])
+{
+	static const uint8_t zero[8];
+
+	return memcmp(id + 8, zero, 8) != 0;
+}
+
+int sdb_id_parse(uint8_t id[16], const char *s)
+{
+	unsigned int i, v;
+
+	if (!strncmp(s, "0x", 2))
+		s += 2;
+	if (strlen(s) != 32) {
+		errno = EINVAL;
+		return -1;
+	}
+	for (i = 0; i < 16; i++) {
+		if (sscanf(s + 2 * i, "%2x", &v) != 1) {
+			errno = EINVAL;
+			return -1;
+		}
+		id[i] = v;
+	}
+	return 0;
+}
+
+void sdb_id_format(char s[33], const uint8_t id[16])
+{
+	static const char hex[] = "0123456789abcdef";
+	unsigned int i;
+
+	for (i = 0; i < 16; i++) {
+		s[2 * i] = hex[id[i] >> 4];
+		s[2 * i + 1] = hex[id[i] & 0xf];
+	}
+	s[32] = '\0';
+}
+
+static char *cache_path(const char *dir, const uint8_t id[16])
+{
+	char hex[33], *path;
+
+	sdb_id_format(hex, id);
+	path = malloc(strlen(dir) + 1 + 32 + sizeof(CACHE_SUFFIX));
+	if (path)
+		sprintf(path, "%s/%s%s", dir, hex, CACHE_SUFFIX);
+	return path;
+}
+
+int sdb_cache_load(struct sdb_table *t, const char *dir, const uint8_t id[16])
+{
+	struct cache_header h;
+	struct sdb_entry *entries = NULL;
+	char *path;
+	FILE *f;
+	int ret = -1;
+
+	if (!sdb_id_cacheable(id)) {
+		errno = EINVAL;
+		return -1;
+	}
+	path = cache_path(dir, id);
+	if (!path)
+		return -1;
+	f = fopen(path, "rb");
+	free(path);
+	if (!f)
+		return -1;
+
+	errno = EINVAL;
+	if (fread(&h, sizeof(h), 1, f) != 1 || h.magic != CACHE_MAGIC ||
+	    h.version != CACHE_VERSION ||
+	    h.entry_size != sizeof(struct sdb_entry) ||
+	    h.n > (1 << 20) || memcmp(h.syn.commit_id, id, 16))
+		goto out;
+	entries = malloc((h.n ? h.n : 1) * sizeof(*entries));
+	if (!entries)
+		goto out;
+	if (fread(entries, sizeof(*entries), h.n, f) != h.n ||
+	    fgetc(f) != EOF) {
+		errno = EINVAL;
+		goto out;
+	}
+
+	sdb_table_free(t);
+	t->entries = entries;
+	t->n = t->size = h.n;
+	t->syn = h.syn;
+	t->have_id = 1;
+	t->rom_addr = h.rom_addr;
+	entries = NULL;
+	ret = index_build(t, t->n);
+out:
+	free(entries);
+	fclose(f);
+	return ret;
+}
+
+int sdb_cache_save(const struct sdb_table *t, const char *dir)
+{
+	struct cache_header h;
+	char *path, *tmp;
+	int ret = -1;
+	FILE *f;
+
+	if (!t->have_id || !sdb_id_cacheable(t->syn.commit_id)) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (mkdir(dir, 0755) && errno != EEXIST)
+		return -1;
+	path = cache_path(dir, t->syn.commit_id);
+	if (!path)
+		return -1;
+	tmp = malloc(strlen(path) + 16);
+	if (!tmp)
+		goto out_path;
+	sprintf(tmp, "%s.%d", path, (int)getpid());
+
+	memset(&h, 0, sizeof(h));
+	h.magic = CACHE_MAGIC;
+	h.version = CACHE_VERSION;
+	h.entry_size = sizeof(struct sdb_entry);
+	h.n = t->n;
+	h.rom_addr = t->rom_addr;
+	h.syn = t->syn;
+
+	/* Write a temporary and rename it: readers see all or nothing */
+	f = fopen(tmp, "wb");
+	if (!f)
+		goto out_tmp;
+	if (fwrite(&h, sizeof(h), 1, f) != 1 ||
+	    fwrite(t->entries, sizeof(*t->entries), t->n, f) != t->n) {
+		fclose(f);
+		goto out_unlink;
+	}
+	if (fclose(f))
+		goto out_unlink;
+	if (!rename(tmp, path)) {
+		ret = 0;
+		goto out_tmp;
+	}
+out_unlink:
+	unlink(tmp);
+out_tmp:
+	free(tmp);
+out_path:
+	free(path);
+	return ret;
+}
+
+/* -------------------------------------------------------------------- */
+/* Printing                                                             */
+/* -------------------------------------------------------------------- */
+
+void sdb_table_print(const struct sdb_table *t, FILE *f)
+{
+	const struct sdb_entry *e;
+	char id[33];
+	unsigned int i;
+
+	if (t->have_id) {
+		sdb_id_format(id, t->syn.commit_id);
+		fprintf(f, "source id %s", id);
+		if (t->syn.module_name[0])
+			fprintf(f, "  %s, %s %08x, %08x, %s",
+				t->syn.module_name, t->syn.tool_name,
+				t->syn.tool_version, t->syn.date,
+				t->syn.user_name);
+		fputc('\n', f);
+		if (t->syn.repo_url[0])
+			fprintf(f, "repo %s\n", t->syn.repo_url);
+	}
+
+	for (i = 0; i < t->n; i++) {
+		e = &t->entries[i];
+		fprintf(f, "%*s", 2 * e->depth, "");
+		switch (e->record_type) {
+		case SDB_RECORD_INTEGRATION:
+			fprintf(f, "%016llx:%08x %-19s version %08x "
+				"(integration)\n",
+				(unsigned long long)e->vendor_id, e->device_id,
+				e->name, e->version);
+			continue;
+		case SDB_RECORD_BRIDGE:
+		case SDB_RECORD_MSI:
+		case SDB_RECORD_DEVICE:
+			break;
+		}
+		fprintf(f, "%016llx:%08x %-19s %08llx-%08llx version %08x%s\n",
+			(unsigned long long)e->vendor_id, e->device_id,
+			e->flags & SDB_ENTRY_METADATA ? "(metadata)" : e->name,
+			(unsigned long long)e->addr_first,
+			(unsigned long long)e->addr_last, e->version,
+			e->record_type == SDB_RECORD_BRIDGE ? " (bridge)" :
+			e->record_type == SDB_RECORD_MSI ? " (msi)" : "");
+	}
+}
+
+/* -------------------------------------------------------------------- */
+/* Bus backends                                                         */
+/* -------------------------------------------------------------------- */
+
+struct mmio_bus {
+	void *map;
+	size_t maplen;
+	volatile uint8_t *base;
+	uint64_t len;
+	int swap;
+};
+
+static int mmio_read(struct sdb_bus *bus, uint64_t addr, uint32_t *words,
+		     unsigned int n)
+{
+	struct mmio_bus *m = bus->priv;
+	volatile uint32_t *p;
+	unsigned int i;
+
+	if ((addr & 3) || addr > m->len || m->len - addr < 4ULL * n) {
+		errno = ERANGE;
+		return -1;
+	}
+	p = (volatile uint32_t *)(m->base + addr);
+	for (i = 0; i < n; i++)
+		words[i] = m->swap ? bswap_32(p[i]) : p[i];
+	return 0;
+}
+
+int sdb_bus_open_mmio(struct sdb_bus *bus, const char *dev, uint64_t offset,
+		      size_t len, int swap)
+{
+	struct mmio_bus *m;
+	struct stat st;
+	long pg = sysconf(_SC_PAGESIZE);
+	int fd;
+
+	fd = open(dev, O_RDONLY | O_SYNC);
+	if (fd < 0)
+		return -1;
+	if (!len) {
+		/* PCI resource files have the size of the BAR */
+		if (fstat(fd, &st) || (uint64_t)st.st_size <= offset) {
+			close(fd);
+			errno = EINVAL;
+			return -1;
+		}
+		len = st.st_size - offset;
+	}
+	m = calloc(1, sizeof(*m));
+	if (!m) {
+		close(fd);
+		return -1;
+	}
+	m->maplen = (offset & (pg - 1)) + len;
+	m->map = mmap(NULL, m->maplen, PROT_READ, MAP_SHARED, fd,
+		      offset & ~(uint64_t)(pg - 1));
+	close(fd);
+	if (m->map == MAP_FAILED) {
+		free(m);
+		return -1;
+	}
+	m->base = (volatile uint8_t *)m->map + (offset & (pg - 1));
+	m->len = len;
+	m->swap = swap;
+	bus->read = mmio_read;
+	bus->priv = m;
+	return 0;
+}
+
+/*
+ * ROM image: the bus address space as a file, address 0 at offset 0, each
+ * word big endian. A sparse file keeps images of widely spread ROMs small.
+ */
+struct file_bus {
+	int fd;
+};
+
+static int file_read(struct sdb_bus *bus, uint64_t addr, uint32_t *words,
+		     unsigned int n)
+{
+	struct file_bus *fb = bus->priv;
+	ssize_t len = 4 * (ssize_t)n;
+	unsigned int i;
+
+	if (pread(fb->fd, words, len, addr) != len) {
+		errno = ERANGE;
+		return -1;
+	}
+	for (i = 0; i < n; i++)
+		words[i] = be32toh(words[i]);
+	return 0;
+}
+
+int sdb_bus_open_file(struct sdb_bus *bus, const char *image)
+{
+	struct file_bus *fb = malloc(sizeof(*fb));
+
+	if (!fb)
+		return -1;
+	fb->fd = open(image, O_RDONLY);
+	if (fb->fd < 0) {
+		free(fb);
+		return -1;
+	}
+	bus->read = file_read;
+	bus->priv = fb;
+	return 0;
+}
+
+void sdb_bus_close(struct sdb_bus *bus)
+{
+	if (bus->read == mmio_read) {
+		struct mmio_bus *m = bus->priv;
+
+		munmap(m->map, m->maplen);
+	} else if (bus->read == file_read) {
+		struct file_bus *fb = bus->priv;
+
+		close(fb->fd);
+	}
+	free(bus->priv);
+	bus->read = NULL;
+	bus->priv = NULL;
+}
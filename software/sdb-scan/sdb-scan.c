@@ -0,0 +1,298 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (c) 2026 CERN
+ *
+ * List the cores of a bitstream from its SDB ROM and xwb_metadata blocks,
+ * or print the address of given vendor:device pairs.
+ *
+ * The result is cached per source ID (sdb-scan.h), so the usual start of
+ * a tool is: get the ID, load the cache, look the cores up. With -k the ID
+ * comes from the command line and a cache hit does not touch the bus at
+ * all; with -m it costs one read of an xwb_metadata block; otherwise the
+ * root SDB ROM is read for its synthesis record (two reads) and the
+ * bridges below it are only walked on a cache miss.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <endian.h>
+
+#include "sdb-scan.h"
+
+#define MAX_META 32
+
+struct bus_args {
+	const char *dev, *image, *dump;
+	uint64_t offset;
+	size_t len;
+	int swap;
+
+	struct sdb_bus bus;		/* what the scanner reads from */
+	struct sdb_bus lower;		/* the device or image, with -D */
+	int dump_fd;
+	unsigned long reads;
+};
+
+/* -D: copy everything read into an image usable with -f */
+static int dump_read(struct sdb_bus *bus, uint64_t addr, uint32_t *words,
+		     unsigned int n)
+{
+	struct bus_args *a = bus->priv;
+	uint32_t be[n];
+	unsigned int i;
+
+	a->reads++;
+	if (a->lower.read(&a->lower, addr, words, n))
+		return -1;
+	for (i = 0; i < n; i++)
+		be[i] = htobe32(words[i]);
+	if (pwrite(a->dump_fd, be, sizeof(be), addr) != (ssize_t)sizeof(be))
+		perror(a->dump);
+	return 0;
+}
+
+static int count_read(struct sdb_bus *bus, uint64_t addr, uint32_t *words,
+		      unsigned int n)
+{
+	struct bus_args *a = bus->priv;
+
+	a->reads++;
+	return a->lower.read(&a->lower, addr, words, n);
+}
+
+/* Open the bus the first time it is needed, NULL on error */
+static struct sdb_bus *get_bus(struct bus_args *a)
+{
+	int ret;
+
+	if (a->bus.read)
+		return &a->bus;
+	if (a->image)
+		ret = sdb_bus_open_file(&a->lower, a->image);
+	else
+		ret = sdb_bus_open_mmio(&a->lower, a->dev, a->offset, a->len,
+					a->swap);
+	if (ret) {
+		perror(a->image ? a->image : a->dev);
+		return NULL;
+	}
+	a->bus.read = count_read;
+	if (a->dump) {
+		a->dump_fd = open(a->dump, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (a->dump_fd < 0) {
+			perror(a->dump);
+			return NULL;
+		}
+		a->bus.read = dump_read;
+	}
+	a->bus.priv = a;
+	return &a->bus;
+}
+
+static const char *default_cache_dir(void)
+{
+	static char dir[4096];
+	const char *env;
+
+	env = getenv("SDB_SCAN_CACHE");
+	if (env)
+		return env;
+	env = getenv("XDG_CACHE_HOME");
+	if (env && *env) {
+		snprintf(dir, sizeof(dir), "%s/sdb-scan", env);
+		return dir;
+	}
+	env = getenv("HOME");
+	if (!env)
+		return NULL;
+	snprintf(dir, sizeof(dir), "%s/.cache/sdb-scan", env);
+	return dir;
+}
+
+/* vendor:device[:instance] */
+static int parse_query(const char *s, uint64_t *vendor, uint32_t *device,
+		       unsigned int *inst)
+{
+	char *end;
+
+	*vendor = strtoull(s, &end, 16);
+	if (*end != ':')
+		return -1;
+	*device = strtoul(end + 1, &end, 16);
+	*inst = 0;
+	if (*end == ':')
+		*inst = strtoul(end + 1, &end, 0);
+	return *end ? -1 : 0;
+}
+
+static void help(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [options] -d <device> [<vendor>:<device>[:<n>] ...]\n"
+		"       %s [options] -f <image> [<vendor>:<device>[:<n>] ...]\n"
+		"\n"
+		"Without queries, list the cores. With queries, print the base\n"
+		"address of instance <n> (default 0) of each, in hex.\n"
+		"\n"
+		"  -d <device>   /dev/mem or a PCI resource file\n"
+		"  -a <offset>   offset of bus address 0 in <device>\n"
+		"  -L <len>      size of the bus window (default: file size)\n"
+		"  -s            the bridge swaps the bytes of each word\n"
+		"  -f <image>    ROM image instead of a device, see -D\n"
+		"  -r <addr>     address of the root SDB ROM (default 0)\n"
+		"  -m <addr>     xwb_metadata block at <addr>, may be repeated;\n"
+		"                without -r, the SDB is not read\n"
+		"  -k <id>       source ID (32 hex digits), skips reading it\n"
+		"  -c <dir>      cache directory (default $SDB_SCAN_CACHE or\n"
+		"                ~/.cache/sdb-scan)\n"
+		"  -n            do not use the cache\n"
+		"  -D <image>    write what is read from the bus to <image>\n"
+		"  -v            report cache use and bus reads on stderr\n",
+		name, name);
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	struct bus_args a = { .dump_fd = -1 };
+	struct sdb_table t;
+	struct sdb_bus *bus;
+	uint64_t rom = 0, meta[MAX_META];
+	unsigned int n_meta = 0, i;
+	const char *cache_dir = NULL;
+	uint8_t id[16];
+	int have_id = 0, use_sdb = 0, use_cache = 1, verbose = 0, hit = 0;
+	int ret = 0, c;
+	char hex[33];
+
+	while ((c = getopt(argc, argv, "d:a:L:sf:r:m:k:c:nD:vh")) != -1) {
+		switch (c) {
+		case 'd': a.dev = optarg; break;
+		case 'a': a.offset = strtoull(optarg, NULL, 0); break;
+		case 'L': a.len = strtoull(optarg, NULL, 0); break;
+		case 's': a.swap = 1; break;
+		case 'f': a.image = optarg; break;
+		case 'r': rom = strtoull(optarg, NULL, 0); use_sdb = 1; break;
+		case 'm':
+			if (n_meta == MAX_META)
+				help(argv[0]);
+			meta[n_meta++] = strtoull(optarg, NULL, 0);
+			break;
+		case 'k':
+			if (sdb_id_parse(id, optarg)) {
+				fprintf(stderr, "%s: bad source ID\n", optarg);
+				return 1;
+			}
+			have_id = 1;
+			break;
+		case 'c': cache_dir = optarg; break;
+		case 'n': use_cache = 0; break;
+		case 'D': a.dump = optarg; break;
+		case 'v': verbose = 1; break;
+		default: help(argv[0]);
+		}
+	}
+	if (!!a.dev == !!a.image)
+		help(argv[0]);
+	if (!n_meta)
+		use_sdb = 1;
+	if (!cache_dir)
+		cache_dir = default_cache_dir();
+	if (!cache_dir || a.dump)
+		use_cache = 0;
+
+	sdb_table_init(&t);
+
+	/* The ID, as cheaply as possible */
+	if (use_cache && !have_id) {
+		bus = get_bus(&a);
+		if (!bus)
+			return 1;
+		if (n_meta) {
+			have_id = !sdb_read_metadata_id(bus, meta[0], id);
+		} else if (!sdb_read_id(&t, bus, rom)) {
+			memcpy(id, t.syn.commit_id, 16);
+			have_id = 1;
+		}
+		sdb_table_free(&t);
+	}
+	if (use_cache && have_id && sdb_id_cacheable(id))
+		hit = !sdb_cache_load(&t, cache_dir, id);
+
+	if (!hit) {
+		bus = get_bus(&a);
+		if (!bus)
+			return 1;
+		if (use_sdb && sdb_scan(&t, bus, rom)) {
+			fprintf(stderr, "SDB at 0x%llx: %s\n",
+				(unsigned long long)rom, strerror(errno));
+			return 1;
+		}
+		for (i = 0; i < n_meta; i++) {
+			if (sdb_add_metadata(&t, bus, meta[i])) {
+				fprintf(stderr, "metadata at 0x%llx: %s\n",
+					(unsigned long long)meta[i],
+					strerror(errno));
+				return 1;
+			}
+		}
+		/*
+		 * A different ID on the bus than -k: another bitstream is
+		 * loaded, the scan is cached under the ID it really has.
+		 */
+		if (have_id && t.have_id && memcmp(id, t.syn.commit_id, 16)) {
+			fprintf(stderr, "warning: the source ID on the bus is "
+				"not the one given with -k\n");
+		} else if (have_id && !t.have_id) {
+			memcpy(t.syn.commit_id, id, 16);
+			t.have_id = 1;
+		}
+		if (use_cache && t.have_id && sdb_id_cacheable(t.syn.commit_id) &&
+		    sdb_cache_save(&t, cache_dir))
+			fprintf(stderr, "%s: %s\n", cache_dir, strerror(errno));
+	}
+
+	if (verbose) {
+		if (t.have_id)
+			sdb_id_format(hex, t.syn.commit_id);
+		fprintf(stderr, "%s, %u entries, %lu bus reads, source id %s\n",
+			hit ? "cache hit" : use_cache ? "cache miss" : "no cache",
+			t.n, a.reads, t.have_id ? hex : "unknown");
+	}
+
+	if (optind == argc)
+		sdb_table_print(&t, stdout);
+	for (i = optind; i < (unsigned int)argc; i++) {
+		const struct sdb_entry *e;
+		unsigned int inst;
+		uint64_t vendor;
+		uint32_t device;
+
+		if (parse_query(argv[i], &vendor, &device, &inst)) {
+			fprintf(stderr, "%s: expected vendor:device[:n]\n",
+				argv[i]);
+			ret = 1;
+			continue;
+		}
+		e = sdb_find(&t, vendor, device, inst);
+		if (!e) {
+			fprintf(stderr, "%s: not found\n", argv[i]);
+			ret = 1;
+			continue;
+		}
+		printf("0x%llx\n", (unsigned long long)e->addr_first);
+	}
+
+	sdb_table_free(&t);
+	if (a.bus.read)
+		sdb_bus_close(&a.lower);
+	if (a.dump_fd >= 0)
+		close(a.dump_fd);
+	return ret;
+}
@@ -0,0 +1,148 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (c) 2026 CERN
+ *
+ * Enumeration of the cores behind an SDB ROM (sdb_rom in xwb_sdb_crossbar)
+ * or xwb_metadata blocks, with an on-disk cache of the result.
+ */
+
+#ifndef __SDB_SCAN_H__
+#define __SDB_SCAN_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* SDB record types */
+#define SDB_RECORD_INTERCONNECT	0x00
+#define SDB_RECORD_DEVICE	0x01
+#define SDB_RECORD_BRIDGE	0x02
+#define SDB_RECORD_MSI		0x03
+#define SDB_RECORD_INTEGRATION	0x80
+#define SDB_RECORD_REPO_URL	0x81
+#define SDB_RECORD_SYNTHESIS	0x82
+#define SDB_RECORD_EMPTY	0xff
+
+#define SDB_MAGIC		0x5344422d	/* "SDB-" */
+#define SDB_RECORD_SIZE		64
+
+/* Maximum bridge nesting, guards against loops in a broken ROM */
+#define SDB_MAX_DEPTH		16
+
+/*
+ * Access to the bus the ROMs are on. read() fetches n consecutive 32-bit
+ * words starting at the byte address addr, as the bus returns them (the
+ * word at the lowest address holds the most significant SDB bits). The
+ * scanner always asks for whole records or ROMs in one call, so a
+ * backend can turn every call into a single burst. Returns 0 or -1 with
+ * errno set.
+ */
+struct sdb_bus {
+	int (*read)(struct sdb_bus *bus, uint64_t addr, uint32_t *words,
+		    unsigned int n);
+	void *priv;
+};
+
+/* sdb_entry.flags */
+#define SDB_ENTRY_METADATA	(1 << 0)	/* from an xwb_metadata block */
+
+/* One device, bridge, MSI or integration record, addresses absolute */
+struct sdb_entry {
+	uint64_t vendor_id;
+	uint32_t device_id;
+	uint32_t version;
+	uint32_t date;
+	uint64_t addr_first;
+	uint64_t addr_last;
+	uint32_t bus_specific;		/* device and MSI records */
+	uint16_t abi_class;
+	uint8_t abi_ver_major;
+	uint8_t abi_ver_minor;
+	uint8_t record_type;
+	uint8_t depth;			/* bridges between the entry and root */
+	uint8_t flags;
+	char name[20];			/* NUL terminated, trailing blanks cut */
+	int32_t next;			/* next instance of the same id, or -1 */
+};
+
+/* Content of the synthesis record (or of xwb_metadata) */
+struct sdb_synthesis {
+	uint8_t commit_id[16];
+	char module_name[17];
+	char tool_name[9];
+	char user_name[16];
+	uint32_t tool_version;
+	uint32_t date;
+	char repo_url[64];
+};
+
+struct sdb_table {
+	struct sdb_entry *entries;
+	unsigned int n, size;
+	int32_t *hash;			/* first entry of each id, or -1 */
+	unsigned int hash_size;		/* power of 2 */
+	struct sdb_synthesis syn;
+	int have_id;			/* syn.commit_id was found */
+	uint64_t rom_addr;		/* root ROM the table was built from */
+	unsigned long bus_reads;	/* bus accesses spent building it */
+};
+
+void sdb_table_init(struct sdb_table *t);
+void sdb_table_free(struct sdb_table *t);
+
+/*
+ * Walk the SDB tree whose root ROM is at rom_addr, following bridges, and
+ * add every record to t. Each ROM takes two bus reads: the interconnect
+ * record, then all the other records at once.
+ */
+int sdb_scan(struct sdb_table *t, struct sdb_bus *bus, uint64_t rom_addr);
+
+/*
+ * Read only the root ROM and fill t->syn from its synthesis record. This
+ * is what is needed to pick a cache file when the ID is not known.
+ */
+int sdb_read_id(struct sdb_table *t, struct sdb_bus *bus, uint64_t rom_addr);
+
+/*
+ * Add the xwb_metadata block at addr (vendor, device, version and source
+ * ID in one 9-word read). The first block with a source ID sets t->syn's
+ * commit_id if the SDB did not.
+ */
+int sdb_add_metadata(struct sdb_table *t, struct sdb_bus *bus, uint64_t addr);
+
+/* Read the source ID of an xwb_metadata block only (one 5-word read) */
+int sdb_read_metadata_id(struct sdb_bus *bus, uint64_t addr, uint8_t id[16]);
+
+/*
+ * Find instance number inst (in scan order) of vendor:device, NULL if
+ * there is none. Constant time apart from walking to the instance.
+ */
+const struct sdb_entry *sdb_find(const struct sdb_table *t,
+				 uint64_t vendor_id, uint32_t device_id,
+				 unsigned int inst);
+
+/* Next instance of the same vendor:device as e, or NULL */
+const struct sdb_entry *sdb_find_next(const struct sdb_table *t,
+				      const struct sdb_entry *e);
+
+/*
+ * Cache, one file per source ID in dir: <dir>/<32 hex digits>.sdb. IDs
+ * from a dirty tree (gen_sourceid.py clears the lower 64 bits) or all
+ * zeros identify no particular build and are never cached.
+ */
+int sdb_id_cacheable(const uint8_t id[16]);
+int sdb_cache_load(struct sdb_table *t, const char *dir, const uint8_t id[16]);
+int sdb_cache_save(const struct sdb_table *t, const char *dir);
+
+/* Parse/format an ID as 32 hex digits */
+int sdb_id_parse(uint8_t id[16], const char *s);
+void sdb_id_format(char s[33], const uint8_t id[16]);
+
+void sdb_table_print(const struct sdb_table *t, FILE *f);
+
+/* Bus backends */
+int sdb_bus_open_mmio(struct sdb_bus *bus, const char *dev, uint64_t offset,
+		      size_t len, int swap);
+int sdb_bus_open_file(struct sdb_bus *bus, const char *image);
+void sdb_bus_close(struct sdb_bus *bus);
+
+#endif /* __SDB_SCAN_H__ */
@@ -0,0 +1,650 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (C) 2026 CERN (www.cern.ch)
+ *
+ * Serial driver for the General-Cores Wishbone UART (wb_simple_uart),
+ * physical UART side.
+ *
+ * The core has no interrupt enable register and its two interrupt lines are
+ * levels: int_o is "RX data available", int_tx_o is "TX FIFO empty" (or
+ * "transmitter idle" without FIFOs). The TX line is enabled at the interrupt
+ * controller only while there is something to send. Each interrupt moves a
+ * whole FIFO: RX drains until RX_RDY drops and pushes to the tty once, TX
+ * fills until TX_BUSY (TX FIFO full) and wakes writers below WAKEUP_CHARS.
+ */
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/init.h>
+#include <linux/version.h>
+#include <linux/platform_device.h>
+#include <linux/platform_data/simple-uart.h>
+#include <linux/io.h>
+#include <linux/interrupt.h>
+#include <linux/timer.h>
+#include <linux/mutex.h>
+#include <linux/serial.h>
+#include <linux/serial_core.h>
+#include <linux/tty.h>
+#include <linux/tty_flip.h>
+#include <linux/math64.h>
+#include <linux/bitops.h>
+#include <linux/errno.h>
+
+#define SIMPLE_UART_NAME "simple-uart"
+#define SIMPLE_UART_DEV_NAME "ttyWBU"
+#define SIMPLE_UART_MAX_PORTS 8
+/* Not in serial_core.h, only reported back through simple_uart_type() */
+#define PORT_SIMPLE_UART 200
+
+/* Registers, see simple_uart_wb.wb */
+#define SIMPLE_UART_SR 0x00
+#define SIMPLE_UART_BCR 0x04
+#define SIMPLE_UART_TDR 0x08
+#define SIMPLE_UART_RDR 0x0C
+#define SIMPLE_UART_CR 0x18
+
+#define SIMPLE_UART_SR_TX_BUSY BIT(0) /* TX FIFO full with FIFOs */
+#define SIMPLE_UART_SR_RX_RDY BIT(1)
+#define SIMPLE_UART_SR_RX_FIFO_SUPPORTED BIT(2)
+#define SIMPLE_UART_SR_TX_FIFO_SUPPORTED BIT(3)
+#define SIMPLE_UART_SR_TX_FIFO_EMPTY BIT(5)
+
+#define SIMPLE_UART_CR_RX_FIFO_PURGE BIT(0)
+#define SIMPLE_UART_CR_TX_FIFO_PURGE BIT(1)
+
+/* Baud rate generator: baud = clk * BCR / 2^19, at most one 8x tick/clock */
+#define SIMPLE_UART_BCR_MAX (1 << 16)
+#define SIMPLE_UART_BAUD_SHIFT 19
+
+/* Bytes moved per RX interrupt, the line stays asserted for the rest */
+#define SIMPLE_UART_RX_BUDGET 256
+
+#define SIMPLE_UART_FLAG_FIFO BIT(0)
+#define SIMPLE_UART_FLAG_TX_IRQ_ON BIT(1)
+#define SIMPLE_UART_FLAG_RX_STOPPED BIT(2)
+
+struct simple_uart {
+	struct uart_port port;
+	unsigned long flags;
+	unsigned int tx_fifo_size;
+	int rx_irq;
+	int tx_irq;
+	struct timer_list poll_timer; /* replaces a missing IRQ */
+
+	/* Register Access functions */
+	uint32_t (*read)(struct simple_uart *su, unsigned int reg);
+	void (*write)(struct simple_uart *su, uint32_t val, unsigned int reg);
+};
+
+#define to_simple_uart(p) container_of(p, struct simple_uart, port)
+
+#if KERNEL_VERSION(6, 1, 0) <= LINUX_VERSION_CODE
+#define SIMPLE_UART_OLD_TERMIOS const struct ktermios
+#else
+#define SIMPLE_UART_OLD_TERMIOS struct ktermios
+#endif
+
+#if KERNEL_VERSION(6, 16, 0) <= LINUX_VERSION_CODE
+#define from_timer timer_container_of
+#endif
+
+#if KERNEL_VERSION(6, 2, 0) > LINUX_VERSION_CODE
+#define timer_delete_sync del_timer_sync
+#endif
+
+#if KERNEL_VERSION(5, 4, 0) > LINUX_VERSION_CODE
+#define platform_get_irq_optional platform_get_irq
+#endif
+
+static inline uint32_t simple_uart_ioread32(struct simple_uart *su,
+					    unsigned int reg)
+{
+	return ioread32(su->port.membase + reg);
+}
+
+static inline void simple_uart_iowrite32(struct simple_uart *su,
+					 uint32_t val, unsigned int reg)
+{
+	iowrite32(val, su->port.membase + reg);
+}
+
+static inline uint32_t simple_uart_ioread32be(struct simple_uart *su,
+					      unsigned int reg)
+{
+	return ioread32be(su->port.membase + reg);
+}
+
+static inline void simple_uart_iowrite32be(struct simple_uart *su,
+					   uint32_t val, unsigned int reg)
+{
+	iowrite32be(val, su->port.membase + reg);
+}
+
+/**
+ * Same rounding as CALC_BAUD() in the LM32 test system uart.c
+ */
+static uint32_t simple_uart_bcr(unsigned int clock_hz, unsigned int baud)
+{
+	return div_u64(((u64)baud << 12) + (clock_hz >> 8), clock_hz >> 7);
+}
+
+static unsigned int simple_uart_bcr_to_baud(unsigned int clock_hz,
+					    uint32_t bcr)
+{
+	return ((u64)clock_hz * bcr) >> SIMPLE_UART_BAUD_SHIFT;
+}
+
+/* Pending bytes in the serial core transmit buffer */
+static unsigned int simple_uart_tx_pending(struct uart_port *port)
+{
+#if KERNEL_VERSION(6, 10, 0) <= LINUX_VERSION_CODE
+	return kfifo_len(&port->state->port.xmit_fifo);
+#else
+	return uart_circ_chars_pending(&port->state->xmit);
+#endif
+}
+
+static bool simple_uart_tx_get(struct uart_port *port, u8 *c)
+{
+#if KERNEL_VERSION(6, 10, 0) <= LINUX_VERSION_CODE
+	return uart_fifo_get(port, c);
+#else
+	struct circ_buf *xmit = &port->state->xmit;
+
+	if (uart_circ_empty(xmit))
+		return false;
+	*c = xmit->buf[xmit->tail];
+	xmit->tail = (xmit->tail + 1) & (UART_XMIT_SIZE - 1);
+	port->icount.tx++;
+	return true;
+#endif
+}
+
+/**
+ * Enable/disable the TX interrupt line. The caller holds the port lock.
+ */
+static void simple_uart_tx_irq(struct simple_uart *su, bool on)
+{
+	if (su->tx_irq < 0 ||
+	    !!(su->flags & SIMPLE_UART_FLAG_TX_IRQ_ON) == on)
+		return;
+
+	if (on) {
+		su->flags |= SIMPLE_UART_FLAG_TX_IRQ_ON;
+		enable_irq(su->tx_irq);
+	} else {
+		su->flags &= ~SIMPLE_UART_FLAG_TX_IRQ_ON;
+		disable_irq_nosync(su->tx_irq);
+	}
+}
+
+/**
+ * Fill the TX FIFO from the transmit buffer. The caller holds the port lock.
+ * When the FIFO is known to be empty and its size is known, size - 1 bytes
+ * are written without looking at the status register.
+ */
+static void simple_uart_tx_chars(struct simple_uart *su)
+{
+	struct uart_port *port = &su->port;
+	unsigned int burst = 0;
+	uint32_t sr;
+	u8 c;
+
+	sr = su->read(su, SIMPLE_UART_SR);
+	if ((su->flags & SIMPLE_UART_FLAG_FIFO) &&
+	    (sr & SIMPLE_UART_SR_TX_FIFO_EMPTY))
+		burst = su->tx_fifo_size ? su->tx_fifo_size - 1 : 0;
+
+	if (port->x_char) {
+		if (!burst && (sr & SIMPLE_UART_SR_TX_BUSY))
+			return;
+		su->write(su, port->x_char, SIMPLE_UART_TDR);
+		port->icount.tx++;
+		port->x_char = 0;
+		if (!burst || !--burst)
+			sr = su->read(su, SIMPLE_UART_SR);
+	}
+
+	if (uart_tx_stopped(port)) {
+		simple_uart_tx_irq(su, false);
+		return;
+	}
+
+	for (;;) {
+		if (!burst && (sr & SIMPLE_UART_SR_TX_BUSY))
+			break;
+		if (!simple_uart_tx_get(port, &c))
+			break;
+		su->write(su, c, SIMPLE_UART_TDR);
+		if (!burst || !--burst)
+			sr = su->read(su, SIMPLE_UART_SR);
+	}
+
+	if (simple_uart_tx_pending(port) < WAKEUP_CHARS)
+		uart_write_wakeup(port);
+
+	simple_uart_tx_irq(su, simple_uart_tx_pending(port) != 0);
+}
+
+/**
+ * Move received bytes to the tty. The caller holds the port lock.
+ */
+static void simple_uart_rx_chars(struct simple_uart *su)
+{
+	struct uart_port *port = &su->port;
+	unsigned int budget = SIMPLE_UART_RX_BUDGET;
+	unsigned int n = 0;
+	u8 c;
+
+	while (budget-- && (su->read(su, SIMPLE_UART_SR) &
+			    SIMPLE_UART_SR_RX_RDY)) {
+		c = su->read(su, SIMPLE_UART_RDR) & 0xFF;
+		port->icount.rx++;
+		if (su->flags & SIMPLE_UART_FLAG_RX_STOPPED)
+			continue;
+		if (uart_handle_sysrq_char(port, c))
+			continue;
+		tty_insert_flip_char(&port->state->port, c, TTY_NORMAL);
+		n++;
+	}
+
+	if (n)
+		tty_flip_buffer_push(&port->state->port);
+}
+
+static irqreturn_t simple_uart_rx_irq_handler(int irq, void *arg)
+{
+	struct simple_uart *su = arg;
+
+	spin_lock(&su->port.lock);
+	simple_uart_rx_chars(su);
+	spin_unlock(&su->port.lock);
+
+	return IRQ_HANDLED;
+}
+
+static irqreturn_t simple_uart_tx_irq_handler(int irq, void *arg)
+{
+	struct simple_uart *su = arg;
+
+	spin_lock(&su->port.lock);
+	simple_uart_tx_chars(su);
+	spin_unlock(&su->port.lock);
+
+	return IRQ_HANDLED;
+}
+
+#if KERNEL_VERSION(4, 15, 0) > LINUX_VERSION_CODE
+static void simple_uart_poll(unsigned long arg)
+{
+	struct simple_uart *su = (struct simple_uart *)arg;
+#else
+static void simple_uart_poll(struct timer_list *t)
+{
+	struct simple_uart *su = from_timer(su, t, poll_timer);
+#endif
+	unsigned long flags;
+
+	spin_lock_irqsave(&su->port.lock, flags);
+	if (su->rx_irq < 0)
+		simple_uart_rx_chars(su);
+	if (su->tx_irq < 0)
+		simple_uart_tx_chars(su);
+	spin_unlock_irqrestore(&su->port.lock, flags);
+
+	mod_timer(&su->poll_timer, jiffies + 1);
+}
+
+static unsigned int simple_uart_tx_empty(struct uart_port *port)
+{
+	struct simple_uart *su = to_simple_uart(port);
+	uint32_t sr = su->read(su, SIMPLE_UART_SR);
+
+	if (su->flags & SIMPLE_UART_FLAG_FIFO)
+		return sr & SIMPLE_UART_SR_TX_FIFO_EMPTY ? TIOCSER_TEMT : 0;
+	return sr & SIMPLE_UART_SR_TX_BUSY ? 0 : TIOCSER_TEMT;
+}
+
+static void simple_uart_set_mctrl(struct uart_port *port, unsigned int mctrl)
+{
+}
+
+static unsigned int simple_uart_get_mctrl(struct uart_port *port)
+{
+	return TIOCM_CAR | TIOCM_DSR | TIOCM_CTS;
+}
+
+static void simple_uart_stop_tx(struct uart_port *port)
+{
+	simple_uart_tx_irq(to_simple_uart(port), false);
+}
+
+static void simple_uart_start_tx(struct uart_port *port)
+{
+	simple_uart_tx_chars(to_simple_uart(port));
+}
+
+static void simple_uart_stop_rx(struct uart_port *port)
+{
+	to_simple_uart(port)->flags |= SIMPLE_UART_FLAG_RX_STOPPED;
+}
+
+static int simple_uart_startup(struct uart_port *port)
+{
+	struct simple_uart *su = to_simple_uart(port);
+	int err;
+
+	if (su->flags & SIMPLE_UART_FLAG_FIFO)
+		su->write(su, SIMPLE_UART_CR_RX_FIFO_PURGE |
+			  SIMPLE_UART_CR_TX_FIFO_PURGE, SIMPLE_UART_CR);
+	su->flags &= ~SIMPLE_UART_FLAG_RX_STOPPED;
+
+	if (su->rx_irq >= 0) {
+		err = request_irq(su->rx_irq, simple_uart_rx_irq_handler, 0,
+				  dev_name(port->dev), su);
+		if (err)
+			return err;
+	}
+	if (su->tx_irq >= 0) {
+		/*
+		 * The line is asserted while the FIFO is empty: the first
+		 * interrupt finds nothing to send and disables it again.
+		 */
+		su->flags |= SIMPLE_UART_FLAG_TX_IRQ_ON;
+		err = request_irq(su->tx_irq, simple_uart_tx_irq_handler, 0,
+				  dev_name(port->dev), su);
+		if (err) {
+			su->flags &= ~SIMPLE_UART_FLAG_TX_IRQ_ON;
+			if (su->rx_irq >= 0)
+				free_irq(su->rx_irq, su);
+			return err;
+		}
+	}
+	if (su->rx_irq < 0 || su->tx_irq < 0)
+		mod_timer(&su->poll_timer, jiffies + 1);
+
+	return 0;
+}
+
+static void simple_uart_shutdown(struct uart_port *port)
+{
+	struct simple_uart *su = to_simple_uart(port);
+
+	timer_delete_sync(&su->poll_timer);
+	if (su->tx_irq >= 0)
+		free_irq(su->tx_irq, su);
+	su->flags &= ~SIMPLE_UART_FLAG_TX_IRQ_ON;
+	if (su->rx_irq >= 0)
+		free_irq(su->rx_irq, su);
+}
+
+static void simple_uart_set_termios(struct uart_port *port,
+				    struct ktermios *termios,
+				    SIMPLE_UART_OLD_TERMIOS *old)
+{
+	struct simple_uart *su = to_simple_uart(port);
+	unsigned long flags;
+	unsigned int baud;
+	uint32_t bcr;
+
+	/* The format is fixed: 8 data bits, no parity, one stop bit */
+	termios->c_cflag &= ~(CSIZE | PARENB | PARODD | CSTOPB | CRTSCTS |
+			      CMSPAR);
+	termios->c_cflag |= CS8 | CLOCAL;
+
+	baud = uart_get_baud_rate(port, termios, old,
+				  simple_uart_bcr_to_baud(port->uartclk, 1) + 1,
+				  simple_uart_bcr_to_baud(port->uartclk,
+							  SIMPLE_UART_BCR_MAX));
+	bcr = simple_uart_bcr(port->uartclk, baud);
+	if (bcr > SIMPLE_UART_BCR_MAX)
+		bcr = SIMPLE_UART_BCR_MAX;
+
+	spin_lock_irqsave(&port->lock, flags);
+	su->write(su, bcr, SIMPLE_UART_BCR);
+	uart_update_timeout(port, termios->c_cflag, baud);
+	spin_unlock_irqrestore(&port->lock, flags);
+
+	if (tty_termios_baud_rate(termios))
+		tty_termios_encode_baud_rate(termios, baud, baud);
+}
+
+static const char *simple_uart_type(struct uart_port *port)
+{
+	return port->type == PORT_UNKNOWN ? NULL : "wb_simple_uart";
+}
+
+static void simple_uart_release_port(struct uart_port *port)
+{
+}
+
+static int simple_uart_request_port(struct uart_port *port)
+{
+	return 0;
+}
+
+static void simple_uart_config_port(struct uart_port *port, int flags)
+{
+	if (flags & UART_CONFIG_TYPE)
+		port->type = PORT_SIMPLE_UART;
+}
+
+static int simple_uart_verify_port(struct uart_port *port,
+				   struct serial_struct *ser)
+{
+	if (ser->type != PORT_UNKNOWN && ser->type != port->type)
+		return -EINVAL;
+	if (ser->baud_base < simple_uart_bcr_to_baud(port->uartclk, 1))
+		return -EINVAL;
+	return 0;
+}
+
+static const struct uart_ops simple_uart_ops = {
+	.tx_empty	= simple_uart_tx_empty,
+	.set_mctrl	= simple_uart_set_mctrl,
+	.get_mctrl	= simple_uart_get_mctrl,
+	.stop_tx	= simple_uart_stop_tx,
+	.start_tx	= simple_uart_start_tx,
+	.stop_rx	= simple_uart_stop_rx,
+	.startup	= simple_uart_startup,
+	.shutdown	= simple_uart_shutdown,
+	.set_termios	= simple_uart_set_termios,
+	.type		= simple_uart_type,
+	.release_port	= simple_uart_release_port,
+	.request_port	= simple_uart_request_port,
+	.config_port	= simple_uart_config_port,
+	.verify_port	= simple_uart_verify_port,
+};
+
+static struct uart_driver simple_uart_driver = {
+	.owner		= THIS_MODULE,
+	.driver_name	= SIMPLE_UART_NAME,
+	.dev_name	= SIMPLE_UART_DEV_NAME,
+	.major		= 0, /* dynamic */
+	.minor		= 0,
+	.nr		= SIMPLE_UART_MAX_PORTS,
+};
+
+static struct simple_uart *simple_uart_ports[SIMPLE_UART_MAX_PORTS];
+static DEFINE_MUTEX(simple_uart_ports_lock);
+
+static int simple_uart_get_line(struct platform_device *pdev,
+				struct simple_uart *su)
+{
+	int line = -EBUSY;
+	int i;
+
+	mutex_lock(&simple_uart_ports_lock);
+	if (pdev->id >= 0 && pdev->id < SIMPLE_UART_MAX_PORTS &&
+	    !simple_uart_ports[pdev->id]) {
+		line = pdev->id;
+	} else {
+		for (i = 0; i < SIMPLE_UART_MAX_PORTS; ++i) {
+			if (!simple_uart_ports[i]) {
+				line = i;
+				break;
+			}
+		}
+	}
+	if (line >= 0)
+		simple_uart_ports[line] = su;
+	mutex_unlock(&simple_uart_ports_lock);
+
+	return line;
+}
+
+static void simple_uart_put_line(int line)
+{
+	mutex_lock(&simple_uart_ports_lock);
+	simple_uart_ports[line] = NULL;
+	mutex_unlock(&simple_uart_ports_lock);
+}
+
+static int simple_uart_probe(struct platform_device *pdev)
+{
+	struct simple_uart_platform_data *pdata;
+	struct simple_uart *su;
+	struct resource *r;
+	uint32_t sr;
+	int err;
+
+	pdata = pdev->dev.platform_data;
+	if (!pdata || !pdata->clock_hz) {
+		dev_err(&pdev->dev, "missing platform data\n");
+		return -EINVAL;
+	}
+
+	su = devm_kzalloc(&pdev->dev, sizeof(*su), GFP_KERNEL);
+	if (!su)
+		return -ENOMEM;
+	platform_set_drvdata(pdev, su);
+
+	r = platform_get_resource(pdev, IORESOURCE_MEM, 0);
+	su->port.membase = devm_ioremap_resource(&pdev->dev, r);
+	if (IS_ERR(su->port.membase))
+		return PTR_ERR(su->port.membase);
+	su->port.mapbase = r->start;
+
+	if (pdata->big_endian) {
+		su->read = simple_uart_ioread32be;
+		su->write = simple_uart_iowrite32be;
+		su->port.iotype = UPIO_MEM32BE;
+	} else {
+		su->read = simple_uart_ioread32;
+		su->write = simple_uart_iowrite32;
+		su->port.iotype = UPIO_MEM32;
+	}
+
+	su->rx_irq = platform_get_irq_optional(pdev, 0);
+	if (su->rx_irq == -EPROBE_DEFER)
+		return su->rx_irq;
+	su->tx_irq = platform_get_irq_optional(pdev, 1);
+	if (su->tx_irq == -EPROBE_DEFER)
+		return su->tx_irq;
+	if (su->rx_irq < 0 || su->tx_irq < 0)
+		dev_info(&pdev->dev, "no %s%s%s IRQ, polling\n",
+			 su->rx_irq < 0 ? "RX" : "",
+			 su->rx_irq < 0 && su->tx_irq < 0 ? "/" : "",
+			 su->tx_irq < 0 ? "TX" : "");
+#if KERNEL_VERSION(4, 15, 0) > LINUX_VERSION_CODE
+	setup_timer(&su->poll_timer, simple_uart_poll, (unsigned long)su);
+#else
+	timer_setup(&su->poll_timer, simple_uart_poll, 0);
+#endif
+
+	sr = su->read(su, SIMPLE_UART_SR);
+	if ((sr & SIMPLE_UART_SR_RX_FIFO_SUPPORTED) &&
+	    (sr & SIMPLE_UART_SR_TX_FIFO_SUPPORTED)) {
+		su->flags |= SIMPLE_UART_FLAG_FIFO;
+		su->tx_fifo_size = pdata->tx_fifo_size;
+	}
+
+	su->port.dev = &pdev->dev;
+	su->port.ops = &simple_uart_ops;
+	su->port.uartclk = pdata->clock_hz;
+	su->port.fifosize = su->tx_fifo_size ? su->tx_fifo_size : 1;
+	su->port.flags = UPF_BOOT_AUTOCONF;
+	su->port.type = PORT_SIMPLE_UART;
+	spin_lock_init(&su->port.lock);
+
+	err = simple_uart_get_line(pdev, su);
+	if (err < 0)
+		return err;
+	su->port.line = err;
+
+	err = uart_add_one_port(&simple_uart_driver, &su->port);
+	if (err) {
+		simple_uart_put_line(su->port.line);
+		return err;
+	}
+
+	dev_info(&pdev->dev, "%s%d, %s FIFOs\n", SIMPLE_UART_DEV_NAME,
+		 su->port.line,
+		 su->flags & SIMPLE_UART_FLAG_FIFO ? "with" : "without");
+
+	return 0;
+}
+
+#if KERNEL_VERSION(6, 11, 0) <= LINUX_VERSION_CODE
+static void simple_uart_remove(struct platform_device *pdev)
+#else
+static int simple_uart_remove(struct platform_device *pdev)
+#endif
+{
+	struct simple_uart *su = platform_get_drvdata(pdev);
+
+	uart_remove_one_port(&simple_uart_driver, &su->port);
+	simple_uart_put_line(su->port.line);
+#if KERNEL_VERSION(6, 11, 0) > LINUX_VERSION_CODE
+	return 0;
+#endif
+}
+
+static const struct platform_device_id simple_uart_id_table[] = {
+	{
+		.name = "simple-uart",
+	},
+	{
+		.name = "wb-simple-uart",
+	},
+	{ .name = "" }, /* last */
+};
+
+static struct platform_driver simple_uart_platform_driver = {
+	.probe		= simple_uart_probe,
+	.remove		= simple_uart_remove,
+	.driver	= {
+		.name	= SIMPLE_UART_NAME,
+		.owner	= THIS_MODULE,
+	},
+	.id_table = simple_uart_id_table,
+};
+
+static int __init simple_uart_init(void)
+{
+	int err;
+
+	err = uart_register_driver(&simple_uart_driver);
+	if (err)
+		return err;
+
+	err = platform_driver_register(&simple_uart_platform_driver);
+	if (err)
+		uart_unregister_driver(&simple_uart_driver);
+
+	return err;
+}
+
+static void __exit simple_uart_exit(void)
+{
+	platform_driver_unregister(&simple_uart_platform_driver);
+	uart_unregister_driver(&simple_uart_driver);
+}
+
+module_init(simple_uart_init);
+module_exit(simple_uart_exit);
+
+MODULE_DESCRIPTION("Serial driver for OHWR General-Cores Wishbone UART");
+MODULE_LICENSE("GPL");
+MODULE_DEVICE_TABLE(platform, simple_uart_id_table);
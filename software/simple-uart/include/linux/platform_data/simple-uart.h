@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (C) 2026 CERN (www.cern.ch)
+ */
+
+#ifndef __SIMPLE_UART_PDATA_H__
+#define __SIMPLE_UART_PDATA_H__
+
+/**
+ * struct simple_uart_platform_data - General-Cores wb_simple_uart data
+ * @big_endian: registers are big endian
+ * @clock_hz: frequency of clk_sys_i, used to program BCR
+ * @tx_fifo_size: g_TX_FIFO_SIZE when g_WITH_PHYSICAL_UART_FIFO is set,
+ *                0 if unknown. Into an empty FIFO the driver writes
+ *                tx_fifo_size - 1 bytes without reading TX_BUSY.
+ *
+ * IORESOURCE_MEM 0 is the register block. IORESOURCE_IRQ 0 is int_o
+ * (RX data available), IORESOURCE_IRQ 1 is int_tx_o (TX FIFO empty, or
+ * transmitter idle without FIFOs). A missing IRQ is replaced by polling.
+ */
+struct simple_uart_platform_data {
+	unsigned int big_endian;
+	unsigned int clock_hz;
+	unsigned int tx_fifo_size;
+};
+
+#endif
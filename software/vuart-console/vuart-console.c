@@ -0,0 +1,412 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (c) 2026 CERN
+ *
+ * Host console for the virtual UART of wb_simple_uart.
+ *
+ * The firmware's TDR writes end up in a FIFO (g_VUART_FIFO_SIZE entries)
+ * that the host reads through HOST_RDR. Every HOST_RDR read returns one
+ * byte, its RDY bit and the number of bytes still in the FIFO, so the
+ * console reads the count with the first byte and then drains that many
+ * bytes back to back, without status reads or sleeps between them. The
+ * poll interval adapts to the traffic so that a poll comes before the
+ * FIFO can fill up; that is where the firmware would start dropping.
+ *
+ * Bytes typed on stdin go to the firmware through HOST_TDR, as many as
+ * HOST_TDR.RDY allows per poll. That path is a single register on the
+ * firmware side (RDR), so it is paced by the firmware reading it.
+ *
+ * With -t the registers are replaced by a stand-in that takes the
+ * "firmware output" from a file or FIFO, for testing without hardware;
+ * -R sets the rate at which the stand-in firmware writes.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/* wb_simple_uart registers, see simple_uart_wb.wb */
+#define UART_REG_HOST_TDR	0x10
+#define UART_REG_HOST_RDR	0x14
+
+#define UART_HOST_TDR_RDY		(1 << 8)
+#define UART_HOST_RDR_DATA_MASK		0xff
+#define UART_HOST_RDR_RDY		(1 << 8)
+#define UART_HOST_RDR_COUNT_SHIFT	9
+#define UART_HOST_RDR_COUNT_MASK	(0xffff << UART_HOST_RDR_COUNT_SHIFT)
+
+#define VUART_BUF_SIZE 4096
+
+struct vuart;
+
+struct vuart_ops {
+	uint32_t (*readl)(struct vuart *vu, unsigned int reg);
+	void (*writel)(struct vuart *vu, uint32_t val, unsigned int reg);
+};
+
+struct vuart {
+	const struct vuart_ops *ops;
+	unsigned int fifo_size;
+
+	/* mmio */
+	volatile uint8_t *base;
+
+	/* stand-in */
+	int in_fd, out_fd;
+	uint8_t *fifo;
+	unsigned int head, tail;	/* free running */
+	uint32_t latch;
+	unsigned int rate;		/* bytes/s, 0: as fast as they come */
+	double credit;
+	struct timespec last;
+	int eof;
+
+	/* statistics */
+	unsigned long long bytes, polls, empty_polls, reads, full_polls;
+	unsigned long long drops;	/* stand-in only */
+};
+
+static uint32_t mmio_readl(struct vuart *vu, unsigned int reg)
+{
+	return *(volatile uint32_t *)(vu->base + reg);
+}
+
+static void mmio_writel(struct vuart *vu, uint32_t val, unsigned int reg)
+{
+	*(volatile uint32_t *)(vu->base + reg) = val;
+}
+
+static const struct vuart_ops mmio_ops = {
+	.readl = mmio_readl,
+	.writel = mmio_writel,
+};
+
+/*
+ * Stand-in: what is readable on in_fd (at most -R bytes/s) is what the
+ * firmware wrote since the last access. It goes into a FIFO of fifo_size
+ * bytes, the rest is lost, like with the real FIFO. HOST_RDR behaves like
+ * the HDL: a latched byte with RDY, refilled from the FIFO after each
+ * read, and the count of the bytes behind it.
+ */
+static void standin_fill(struct vuart *vu)
+{
+	uint8_t buf[VUART_BUF_SIZE];
+	size_t want = sizeof(buf);
+	struct timespec now;
+	ssize_t n, i;
+
+	if (vu->rate) {
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		vu->credit += vu->rate *
+			((now.tv_sec - vu->last.tv_sec) +
+			 (now.tv_nsec - vu->last.tv_nsec) * 1e-9);
+		vu->last = now;
+		if (vu->credit > sizeof(buf))
+			vu->credit = sizeof(buf);
+		want = vu->credit;
+	}
+	n = want ? read(vu->in_fd, buf, want) : -1;
+	if (n == 0)
+		vu->eof = 1;
+	if (n > 0)
+		vu->credit -= n;
+	for (i = 0; i < n; i++) {
+		if (vu->head - vu->tail < vu->fifo_size)
+			vu->fifo[vu->head++ % vu->fifo_size] = buf[i];
+		else
+			vu->drops++;
+	}
+	if (!(vu->latch & UART_HOST_RDR_RDY) && vu->head != vu->tail)
+		vu->latch = UART_HOST_RDR_RDY |
+			    vu->fifo[vu->tail++ % vu->fifo_size];
+}
+
+static uint32_t standin_readl(struct vuart *vu, unsigned int reg)
+{
+	uint32_t v;
+
+	switch (reg) {
+	case UART_REG_HOST_TDR:
+		return UART_HOST_TDR_RDY;
+	case UART_REG_HOST_RDR:
+		standin_fill(vu);
+		v = vu->latch |
+		    (vu->head - vu->tail) << UART_HOST_RDR_COUNT_SHIFT;
+		vu->latch = 0;
+		standin_fill(vu);
+		return v;
+	}
+	return 0;
+}
+
+static void standin_writel(struct vuart *vu, uint32_t val, unsigned int reg)
+{
+	uint8_t c = val & UART_HOST_RDR_DATA_MASK;
+
+	if (reg == UART_REG_HOST_TDR && vu->out_fd >= 0 &&
+	    write(vu->out_fd, &c, 1) != 1)
+		perror("stand-in write");
+}
+
+static const struct vuart_ops standin_ops = {
+	.readl = standin_readl,
+	.writel = standin_writel,
+};
+
+/*
+ * Drain the VUART FIFO into buf. The first read tells how many more bytes
+ * there are; those are read back to back. A read without RDY ends the
+ * burst (the next byte has not reached the register yet), the next poll
+ * picks it up.
+ */
+static size_t vuart_drain(struct vuart *vu, uint8_t *buf, size_t size)
+{
+	unsigned int count;
+	size_t n = 0;
+	uint32_t v;
+
+	vu->polls++;
+	do {
+		v = vu->ops->readl(vu, UART_REG_HOST_RDR);
+		vu->reads++;
+		if (!(v & UART_HOST_RDR_RDY))
+			break;
+		buf[n++] = v & UART_HOST_RDR_DATA_MASK;
+		count = (v & UART_HOST_RDR_COUNT_MASK) >>
+			UART_HOST_RDR_COUNT_SHIFT;
+		if (n == 1 && count + 1 >= vu->fifo_size)
+			vu->full_polls++;
+	} while (count && n < size);
+
+	if (!n)
+		vu->empty_polls++;
+	vu->bytes += n;
+	return n;
+}
+
+/* Send as much of buf as HOST_TDR takes now, returns the bytes sent */
+static size_t vuart_send(struct vuart *vu, const uint8_t *buf, size_t len)
+{
+	size_t n;
+
+	for (n = 0; n < len; n++) {
+		if (!(vu->ops->readl(vu, UART_REG_HOST_TDR) & UART_HOST_TDR_RDY))
+			break;
+		vu->ops->writel(vu, buf[n], UART_REG_HOST_TDR);
+	}
+	return n;
+}
+
+/*
+ * Next poll interval: aim at finding the FIFO a quarter full, from the rate
+ * seen in the last interval. Grow at most 2x per poll, so a burst after
+ * a quiet period is caught, and go straight down when traffic picks up.
+ */
+static unsigned int next_interval(unsigned int us, size_t got,
+				  unsigned int fifo_size,
+				  unsigned int min_us, unsigned int max_us)
+{
+	unsigned long long next;
+
+	if (!got)
+		next = (unsigned long long)us * 2;
+	else
+		next = (unsigned long long)us * (fifo_size / 4) / got;
+	if (next > (unsigned long long)us * 2)
+		next = (unsigned long long)us * 2;
+	if (next < min_us)
+		next = min_us;
+	if (next > max_us)
+		next = max_us;
+	return next;
+}
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig)
+{
+	stop = 1;
+}
+
+static void help(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [options] -d <device> [-a <offset>]\n"
+		"       %s [options] -t <input>[:<output>]\n"
+		"\n"
+		"  -d <device>   file to map the UART from: /dev/mem or a PCI\n"
+		"                resource (/sys/bus/pci/devices/.../resourceN)\n"
+		"  -a <offset>   offset of the UART registers in <device>\n"
+		"  -t <in[:out]> stand-in: firmware output is read from <in>\n"
+		"                (file or FIFO), HOST_TDR bytes go to <out>\n"
+		"  -R <rate>     stand-in firmware output rate, bytes/s\n"
+		"  -F <size>     VUART FIFO size, g_VUART_FIFO_SIZE (1024)\n"
+		"  -i <us>       minimum poll interval (100)\n"
+		"  -I <us>       maximum poll interval (20000)\n"
+		"  -l <file>     also append the console output to <file>\n"
+		"  -x            exit when the stand-in input ends\n"
+		"  -v            print statistics on exit\n",
+		name, name);
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	struct vuart vu = { .fifo_size = 1024, .in_fd = -1, .out_fd = -1 };
+	unsigned int min_us = 100, max_us = 20000, us;
+	const char *dev = NULL, *standin = NULL, *logname = NULL;
+	uint8_t rx[VUART_BUF_SIZE], tx[VUART_BUF_SIZE];
+	size_t txlen = 0, n;
+	struct termios tio, tio_saved;
+	int tty = 0, verbose = 0, exit_on_eof = 0, fd, c;
+	FILE *logf = NULL;
+	off_t offset = 0;
+	void *map = NULL;
+	size_t maplen = 0;
+	long pg;
+
+	while ((c = getopt(argc, argv, "d:a:t:R:F:i:I:l:xvh")) != -1) {
+		switch (c) {
+		case 'd': dev = optarg; break;
+		case 'a': offset = strtoull(optarg, NULL, 0); break;
+		case 't': standin = optarg; break;
+		case 'R': vu.rate = strtoul(optarg, NULL, 0); break;
+		case 'F': vu.fifo_size = strtoul(optarg, NULL, 0); break;
+		case 'i': min_us = strtoul(optarg, NULL, 0); break;
+		case 'I': max_us = strtoul(optarg, NULL, 0); break;
+		case 'l': logname = optarg; break;
+		case 'x': exit_on_eof = 1; break;
+		case 'v': verbose = 1; break;
+		default: help(argv[0]);
+		}
+	}
+	if (!!dev == !!standin || !vu.fifo_size || !min_us || min_us > max_us)
+		help(argv[0]);
+
+	if (standin) {
+		char *in = strdup(standin), *out = strchr(in, ':');
+
+		if (out) {
+			*out++ = '\0';
+			vu.out_fd = open(out, O_WRONLY | O_CREAT | O_APPEND, 0644);
+			if (vu.out_fd < 0) {
+				perror(out);
+				return 1;
+			}
+		}
+		/* O_RDWR keeps a FIFO open when its writer goes away */
+		vu.in_fd = open(in, (exit_on_eof ? O_RDONLY : O_RDWR) |
+				O_NONBLOCK);
+		if (vu.in_fd < 0) {
+			perror(in);
+			return 1;
+		}
+		vu.fifo = calloc(vu.fifo_size, 1);
+		if (!vu.fifo)
+			return 1;
+		vu.ops = &standin_ops;
+		clock_gettime(CLOCK_MONOTONIC, &vu.last);
+		free(in);
+	} else {
+		fd = open(dev, O_RDWR | O_SYNC);
+		if (fd < 0) {
+			perror(dev);
+			return 1;
+		}
+		pg = sysconf(_SC_PAGESIZE);
+		maplen = (offset & (pg - 1)) + UART_REG_HOST_RDR + 4;
+		map = mmap(NULL, maplen, PROT_READ | PROT_WRITE, MAP_SHARED,
+			   fd, offset & ~(off_t)(pg - 1));
+		close(fd);
+		if (map == MAP_FAILED) {
+			perror("mmap");
+			return 1;
+		}
+		vu.base = (volatile uint8_t *)map + (offset & (pg - 1));
+		vu.ops = &mmio_ops;
+	}
+
+	if (logname) {
+		logf = fopen(logname, "a");
+		if (!logf) {
+			perror(logname);
+			return 1;
+		}
+	}
+
+	if (isatty(STDIN_FILENO) && !tcgetattr(STDIN_FILENO, &tio_saved)) {
+		tio = tio_saved;
+		tio.c_lflag &= ~(ICANON | ECHO);
+		tio.c_cc[VMIN] = 0;
+		tio.c_cc[VTIME] = 0;
+		tcsetattr(STDIN_FILENO, TCSANOW, &tio);
+		tty = 1;
+	}
+	fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+
+	us = min_us;
+	while (!stop) {
+		n = vuart_drain(&vu, rx, sizeof(rx));
+		if (n) {
+			if (write(STDOUT_FILENO, rx, n) != (ssize_t)n)
+				break;
+			if (logf)
+				fwrite(rx, 1, n, logf);
+		}
+
+		if (txlen < sizeof(tx)) {
+			ssize_t r = read(STDIN_FILENO, tx + txlen,
+					 sizeof(tx) - txlen);
+
+			if (r > 0)
+				txlen += r;
+		}
+		if (txlen) {
+			size_t sent = vuart_send(&vu, tx, txlen);
+
+			memmove(tx, tx + sent, txlen - sent);
+			txlen -= sent;
+		}
+
+		/* more than one burst's worth waiting: go again right away */
+		if (n == sizeof(rx))
+			continue;
+		if (exit_on_eof && vu.eof && !n && vu.head == vu.tail)
+			break;
+
+		us = next_interval(us, n, vu.fifo_size, min_us, max_us);
+		usleep(us);
+	}
+
+	if (tty)
+		tcsetattr(STDIN_FILENO, TCSANOW, &tio_saved);
+	if (logf)
+		fclose(logf);
+	if (map)
+		munmap(map, maplen);
+
+	if (verbose) {
+		fprintf(stderr,
+			"%llu bytes, %llu polls (%llu empty, %llu with a full FIFO), "
+			"%.2f reads/byte\n",
+			vu.bytes, vu.polls, vu.empty_polls, vu.full_polls,
+			vu.bytes ? (double)vu.reads / vu.bytes : 0.0);
+		if (standin)
+			fprintf(stderr, "stand-in: %llu bytes dropped\n",
+				vu.drops);
+	}
+
+	return 0;
+}
@@ -0,0 +1,949 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (C) 2026 CERN (www.cern.ch)
+ *
+ * dmaengine driver for the General-Cores Wishbone DMA (xwb_dma), using its
+ * descriptor mode.
+ *
+ * The descriptors are in a ring in coherent memory, each one pointing to
+ * the next. A transfer is written to the free slots after the last one
+ * given to the DMA, the valid flag last, and 0x14 is written with the
+ * address of the first new slot: if the DMA is idle (it stopped at that
+ * slot, which was not valid) it starts there, otherwise it just goes on,
+ * so the DMA never stops between transfers that are queued in time.
+ *
+ * The DMA writes the status back into each slot. Completion is read from
+ * the ring, not from the interrupt: interrupt_o is a one-cycle pulse that
+ * a busy HT-VIC can miss, and it is only requested for the descriptors
+ * that need it (DMA_PREP_INTERRUPT, or the slot that fills the ring). A
+ * slow poll while transfers are pending catches a missed pulse.
+ */
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/init.h>
+#include <linux/version.h>
+#include <linux/platform_device.h>
+#include <linux/platform_data/wb-dma.h>
+#include <linux/dmaengine.h>
+#include <linux/dma-mapping.h>
+#include <linux/scatterlist.h>
+#include <linux/interrupt.h>
+#include <linux/timer.h>
+#include <linux/spinlock.h>
+#include <linux/slab.h>
+#include <linux/delay.h>
+#include <linux/io.h>
+#include <linux/bitops.h>
+#include <linux/errno.h>
+
+#define WB_DMA_NAME "wb-dma"
+
+/* Registers, see xwb_dma.vhd */
+#define WB_DMA_REG_READ_ADDR	0x00
+#define WB_DMA_REG_WRITE_ADDR	0x04
+#define WB_DMA_REG_READ_STRIDE	0x08
+#define WB_DMA_REG_WRITE_STRIDE	0x0C
+#define WB_DMA_REG_COUNT	0x10
+#define WB_DMA_REG_DESC		0x14
+#define WB_DMA_REG_DESC_CSR	0x18
+
+#define WB_DMA_CSR_RUNNING	BIT(0) /* read */
+#define WB_DMA_CSR_FETCH_ERR	BIT(1) /* read */
+#define WB_DMA_CSR_STOP		BIT(0) /* write */
+
+/* Descriptor, 32 byte aligned */
+struct wb_dma_hw_desc {
+	u32 flags;
+	u32 src;
+	u32 dst;
+	u32 src_stride;
+	u32 dst_stride;
+	u32 count;	/* words */
+	u32 next;
+	u32 reserved;
+};
+
+#define WB_DMA_DESC_VALID	BIT(0)
+#define WB_DMA_DESC_IRQ		BIT(1)
+#define WB_DMA_DESC_LAST	BIT(2)
+#define WB_DMA_DESC_ERR		BIT(30)
+#define WB_DMA_DESC_DONE	BIT(31)
+
+#define WB_DMA_N_DESC 64
+#define WB_DMA_POLL_MS 10
+/* Wait in device_synchronize for the descriptor stopped in terminate_all */
+#define WB_DMA_STOP_TIMEOUT_MS 1000
+
+struct wb_dma_seg {
+	u32 src;
+	u32 dst;
+	u32 src_stride;
+	u32 dst_stride;
+	u32 count;
+};
+
+struct wb_dma_txd {
+	struct dma_async_tx_descriptor tx;
+	struct list_head node;
+	unsigned int n_segs;
+	unsigned int n_queued;	/* segments written to the ring */
+	unsigned int n_done;	/* segments the DMA is done with */
+	bool error;
+	struct wb_dma_seg segs[];
+};
+
+struct wb_dma {
+	struct dma_device dma;
+	struct dma_chan chan;
+	struct device *dev;
+	void __iomem *base;
+	int irq;
+	bool desc_be;
+	u64 dma_offset;
+
+	spinlock_t lock;
+	struct wb_dma_hw_desc *ring;
+	dma_addr_t ring_dma;
+	unsigned int n_slots;
+	struct wb_dma_txd **slot_txd;
+	unsigned int head;	/* next slot to write */
+	unsigned int tail;	/* oldest slot given to the DMA */
+	unsigned int in_flight;
+
+	struct list_head submitted;	/* tx_submit() */
+	struct list_head queue;		/* issued, not complete, in order */
+	struct list_head done;		/* complete, callback pending */
+
+	/*
+	 * After terminate_all, the DMA may still be copying the descriptor
+	 * it was at. Until it stops, the transfers that were in the ring
+	 * keep their buffers, and the ring is left alone.
+	 */
+	bool stopping;
+	struct list_head terminated;	/* were in the ring, DMA running */
+	struct list_head dropped;	/* to free, without callback */
+
+	struct tasklet_struct tasklet;
+	struct timer_list poll_timer;
+	unsigned long poll_period;
+
+	struct dma_slave_config cfg;
+
+	/* Register Access functions */
+	u32 (*read)(struct wb_dma *wd, unsigned int reg);
+	void (*write)(struct wb_dma *wd, u32 val, unsigned int reg);
+};
+
+#define to_wb_dma(c) container_of(c, struct wb_dma, chan)
+#define to_wb_dma_txd(t) container_of(t, struct wb_dma_txd, tx)
+
+#if KERNEL_VERSION(6, 16, 0) <= LINUX_VERSION_CODE
+#define from_timer timer_container_of
+#endif
+
+#if KERNEL_VERSION(6, 2, 0) > LINUX_VERSION_CODE
+#define timer_delete_sync del_timer_sync
+#endif
+
+#if KERNEL_VERSION(5, 4, 0) > LINUX_VERSION_CODE
+#define platform_get_irq_optional platform_get_irq
+#endif
+
+static inline u32 wb_dma_ioread32(struct wb_dma *wd, unsigned int reg)
+{
+	return ioread32(wd->base + reg);
+}
+
+static inline void wb_dma_iowrite32(struct wb_dma *wd, u32 val,
+				    unsigned int reg)
+{
+	iowrite32(val, wd->base + reg);
+}
+
+static inline u32 wb_dma_ioread32be(struct wb_dma *wd, unsigned int reg)
+{
+	return ioread32be(wd->base + reg);
+}
+
+static inline void wb_dma_iowrite32be(struct wb_dma *wd, u32 val,
+				      unsigned int reg)
+{
+	iowrite32be(val, wd->base + reg);
+}
+
+/* Descriptor words, in the order the DMA reads them */
+static inline void wb_dma_desc_set(struct wb_dma *wd, u32 *p, u32 val)
+{
+	WRITE_ONCE(*p, wd->desc_be ? (__force u32)cpu_to_be32(val) :
+				     (__force u32)cpu_to_le32(val));
+}
+
+static inline u32 wb_dma_desc_get(struct wb_dma *wd, u32 *p)
+{
+	u32 val = READ_ONCE(*p);
+
+	return wd->desc_be ? be32_to_cpu((__force __be32)val) :
+			     le32_to_cpu((__force __le32)val);
+}
+
+/* Wishbone address of a slot */
+static u32 wb_dma_slot_addr(struct wb_dma *wd, unsigned int slot)
+{
+	return wd->dma_offset + wd->ring_dma +
+		slot * sizeof(struct wb_dma_hw_desc);
+}
+
+/**
+ * Wishbone address of a memory buffer, 0 if the masters can't reach it
+ * (address 0 is where the DMA's own registers usually are, never memory).
+ */
+static u32 wb_dma_mem_addr(struct wb_dma *wd, dma_addr_t addr, size_t len)
+{
+	u64 wb = wd->dma_offset + addr;
+
+	if (wb + len > BIT_ULL(32)) {
+		dev_err_ratelimited(wd->dev, "%pad not reachable\n", &addr);
+		return 0;
+	}
+	return wb;
+}
+
+/**
+ * All slots done and not valid, chained into a ring. The DMA is stopped.
+ */
+static void wb_dma_ring_reset(struct wb_dma *wd)
+{
+	unsigned int i;
+
+	for (i = 0; i < wd->n_slots; i++) {
+		wb_dma_desc_set(wd, &wd->ring[i].flags, WB_DMA_DESC_DONE);
+		wb_dma_desc_set(wd, &wd->ring[i].next,
+				wb_dma_slot_addr(wd, (i + 1) % wd->n_slots));
+		wd->slot_txd[i] = NULL;
+	}
+	wd->head = 0;
+	wd->tail = 0;
+	wd->in_flight = 0;
+	wmb();
+}
+
+/**
+ * Write the segments of the queued transfers to the free slots and start
+ * the DMA. The caller holds the lock.
+ */
+static void wb_dma_fill(struct wb_dma *wd)
+{
+	struct wb_dma_hw_desc *d;
+	struct wb_dma_txd *txd;
+	struct wb_dma_seg *seg;
+	unsigned int first = wd->head;
+	bool queued = false;
+	u32 flags;
+
+	if (wd->stopping)
+		return;
+
+	list_for_each_entry(txd, &wd->queue, node) {
+		while (txd->n_queued < txd->n_segs &&
+		       wd->in_flight < wd->n_slots) {
+			seg = &txd->segs[txd->n_queued];
+			d = &wd->ring[wd->head];
+
+			flags = WB_DMA_DESC_VALID;
+			if (txd->n_queued == txd->n_segs - 1 &&
+			    (txd->tx.flags & DMA_PREP_INTERRUPT))
+				flags |= WB_DMA_DESC_IRQ;
+			/* Get the rest queued when the ring has room again */
+			if (wd->in_flight == wd->n_slots - 1)
+				flags |= WB_DMA_DESC_IRQ;
+
+			wb_dma_desc_set(wd, &d->src, seg->src);
+			wb_dma_desc_set(wd, &d->dst, seg->dst);
+			wb_dma_desc_set(wd, &d->src_stride, seg->src_stride);
+			wb_dma_desc_set(wd, &d->dst_stride, seg->dst_stride);
+			wb_dma_desc_set(wd, &d->count, seg->count);
+			/* The DMA reads the flags first, valid means complete */
+			dma_wmb();
+			wb_dma_desc_set(wd, &d->flags, flags);
+
+			wd->slot_txd[wd->head] = txd;
+			wd->head = (wd->head + 1) % wd->n_slots;
+			wd->in_flight++;
+			txd->n_queued++;
+			queued = true;
+		}
+		if (txd->n_queued < txd->n_segs)
+			break; /* ring full */
+	}
+	if (!queued)
+		return;
+
+	/* Start, or make a running DMA look at the slots again */
+	wmb();
+	wd->write(wd, wb_dma_slot_addr(wd, first), WB_DMA_REG_DESC);
+
+	if (!timer_pending(&wd->poll_timer))
+		mod_timer(&wd->poll_timer, jiffies + wd->poll_period);
+}
+
+/**
+ * Take back the slots the DMA is done with and move the transfers they
+ * complete to the done list. The caller holds the lock.
+ */
+static void wb_dma_reclaim(struct wb_dma *wd)
+{
+	struct wb_dma_txd *txd, *tmp;
+	u32 flags;
+
+	if (wd->stopping)
+		return;
+
+	while (wd->in_flight) {
+		flags = wb_dma_desc_get(wd, &wd->ring[wd->tail].flags);
+		if ((flags & WB_DMA_DESC_VALID) || !(flags & WB_DMA_DESC_DONE))
+			break;
+		/* The status before anything else of the slot */
+		dma_rmb();
+		txd = wd->slot_txd[wd->tail];
+		if (flags & WB_DMA_DESC_ERR)
+			txd->error = true;
+		txd->n_done++;
+		wd->slot_txd[wd->tail] = NULL;
+		wd->tail = (wd->tail + 1) % wd->n_slots;
+		wd->in_flight--;
+	}
+
+	list_for_each_entry_safe(txd, tmp, &wd->queue, node) {
+		if (txd->n_done < txd->n_segs)
+			break;
+		wd->chan.completed_cookie = txd->tx.cookie;
+		list_move_tail(&txd->node, &wd->done);
+	}
+}
+
+/**
+ * The DMA stopped with slots still valid: a descriptor could not be read.
+ * Fail the transfers in the ring and start again after them. The caller
+ * holds the lock.
+ */
+static void wb_dma_recover(struct wb_dma *wd)
+{
+	struct wb_dma_txd *txd, *tmp;
+	u32 csr;
+
+	if (!wd->in_flight)
+		return;
+	csr = wd->read(wd, WB_DMA_REG_DESC_CSR);
+	if (csr & WB_DMA_CSR_RUNNING)
+		return;
+	/* Done since the last look? */
+	wb_dma_reclaim(wd);
+	if (!wd->in_flight)
+		return;
+
+	dev_err(wd->dev, "stopped at descriptor 0x%08x%s\n",
+		wd->read(wd, WB_DMA_REG_DESC),
+		csr & WB_DMA_CSR_FETCH_ERR ? ", read error" : "");
+	list_for_each_entry_safe(txd, tmp, &wd->queue, node) {
+		if (!txd->n_queued)
+			break;
+		txd->error = true;
+		wd->chan.completed_cookie = txd->tx.cookie;
+		list_move_tail(&txd->node, &wd->done);
+	}
+	wb_dma_ring_reset(wd);
+	wb_dma_fill(wd);
+}
+
+/**
+ * After terminate_all: once the DMA has stopped, give up the transfers that
+ * were in the ring and start the ring over. The caller holds the lock.
+ *
+ * Return: true if the DMA is stopped
+ */
+static bool wb_dma_stopped(struct wb_dma *wd)
+{
+	if (!wd->stopping)
+		return true;
+	if (wd->read(wd, WB_DMA_REG_DESC_CSR) & WB_DMA_CSR_RUNNING)
+		return false;
+	list_splice_tail_init(&wd->terminated, &wd->dropped);
+	wb_dma_ring_reset(wd);
+	wd->stopping = false;
+	return true;
+}
+
+static void wb_dma_txd_free_list(struct list_head *list)
+{
+	struct wb_dma_txd *txd, *tmp;
+
+	list_for_each_entry_safe(txd, tmp, list, node) {
+		dma_descriptor_unmap(&txd->tx);
+		list_del(&txd->node);
+		kfree(txd);
+	}
+}
+
+#if KERNEL_VERSION(5, 9, 0) > LINUX_VERSION_CODE
+static void wb_dma_tasklet(unsigned long arg)
+{
+	struct wb_dma *wd = (struct wb_dma *)arg;
+#else
+static void wb_dma_tasklet(struct tasklet_struct *t)
+{
+	struct wb_dma *wd = from_tasklet(wd, t, tasklet);
+#endif
+	struct dmaengine_result res = { .residue = 0 };
+	struct wb_dma_txd *txd, *tmp;
+	unsigned long flags;
+	LIST_HEAD(done);
+	LIST_HEAD(dropped);
+
+	spin_lock_irqsave(&wd->lock, flags);
+	wb_dma_reclaim(wd);
+	wb_dma_fill(wd);
+	list_splice_tail_init(&wd->done, &done);
+	list_splice_tail_init(&wd->dropped, &dropped);
+	spin_unlock_irqrestore(&wd->lock, flags);
+
+	wb_dma_txd_free_list(&dropped);
+
+	list_for_each_entry_safe(txd, tmp, &done, node) {
+		struct dma_async_tx_descriptor *tx = &txd->tx;
+
+		res.result = txd->error ? DMA_TRANS_ABORTED :
+					  DMA_TRANS_NOERROR;
+		if (tx->callback_result)
+			tx->callback_result(tx->callback_param, &res);
+		else if (tx->callback)
+			tx->callback(tx->callback_param);
+		dma_descriptor_unmap(tx);
+		list_del(&txd->node);
+		kfree(txd);
+	}
+}
+
+static irqreturn_t wb_dma_irq_handler(int irq, void *arg)
+{
+	struct wb_dma *wd = arg;
+
+	tasklet_schedule(&wd->tasklet);
+	return IRQ_HANDLED;
+}
+
+#if KERNEL_VERSION(4, 15, 0) > LINUX_VERSION_CODE
+static void wb_dma_poll(unsigned long arg)
+{
+	struct wb_dma *wd = (struct wb_dma *)arg;
+#else
+static void wb_dma_poll(struct timer_list *t)
+{
+	struct wb_dma *wd = from_timer(wd, t, poll_timer);
+#endif
+	unsigned long flags;
+
+	spin_lock_irqsave(&wd->lock, flags);
+	if (wb_dma_stopped(wd))
+		wb_dma_recover(wd);
+	if (wd->stopping || wd->in_flight || !list_empty(&wd->queue))
+		mod_timer(&wd->poll_timer, jiffies + wd->poll_period);
+	spin_unlock_irqrestore(&wd->lock, flags);
+
+	tasklet_schedule(&wd->tasklet);
+}
+
+static dma_cookie_t wb_dma_tx_submit(struct dma_async_tx_descriptor *tx)
+{
+	struct wb_dma *wd = to_wb_dma(tx->chan);
+	struct wb_dma_txd *txd = to_wb_dma_txd(tx);
+	unsigned long flags;
+	dma_cookie_t cookie;
+
+	spin_lock_irqsave(&wd->lock, flags);
+	cookie = tx->chan->cookie + 1;
+	if (cookie < DMA_MIN_COOKIE)
+		cookie = DMA_MIN_COOKIE;
+	tx->chan->cookie = cookie;
+	tx->cookie = cookie;
+	list_add_tail(&txd->node, &wd->submitted);
+	spin_unlock_irqrestore(&wd->lock, flags);
+
+	return cookie;
+}
+
+static struct wb_dma_txd *wb_dma_txd_alloc(struct wb_dma *wd,
+					   unsigned int n_segs,
+					   unsigned long flags)
+{
+	struct wb_dma_txd *txd;
+
+	txd = kzalloc(sizeof(*txd) + n_segs * sizeof(txd->segs[0]),
+		      GFP_NOWAIT);
+	if (!txd)
+		return NULL;
+	dma_async_tx_descriptor_init(&txd->tx, &wd->chan);
+	txd->tx.tx_submit = wb_dma_tx_submit;
+	txd->tx.flags = flags;
+	txd->n_segs = n_segs;
+	INIT_LIST_HEAD(&txd->node);
+	return txd;
+}
+
+static struct dma_async_tx_descriptor *
+wb_dma_prep_dma_memcpy(struct dma_chan *chan, dma_addr_t dst, dma_addr_t src,
+		       size_t len, unsigned long flags)
+{
+	struct wb_dma *wd = to_wb_dma(chan);
+	struct wb_dma_txd *txd;
+	u32 wb_src, wb_dst;
+
+	if (!len || len % 4 || len / 4 > U32_MAX)
+		return NULL;
+	wb_src = wb_dma_mem_addr(wd, src, len);
+	wb_dst = wb_dma_mem_addr(wd, dst, len);
+	if (!wb_src || !wb_dst)
+		return NULL;
+
+	txd = wb_dma_txd_alloc(wd, 1, flags);
+	if (!txd)
+		return NULL;
+	txd->segs[0] = (struct wb_dma_seg) {
+		.src = wb_src,
+		.dst = wb_dst,
+		.src_stride = 4,
+		.dst_stride = 4,
+		.count = len / 4,
+	};
+	return &txd->tx;
+}
+
+/**
+ * One descriptor per scatterlist entry, the device side is a FIFO: its
+ * address from dma_slave_config, which is a Wishbone address, and a
+ * stride of 0.
+ */
+static struct dma_async_tx_descriptor *
+wb_dma_prep_slave_sg(struct dma_chan *chan, struct scatterlist *sgl,
+		     unsigned int sg_len, enum dma_transfer_direction dir,
+		     unsigned long flags, void *context)
+{
+	struct wb_dma *wd = to_wb_dma(chan);
+	struct wb_dma_txd *txd;
+	struct scatterlist *sg;
+	unsigned int i;
+	u32 fifo, mem;
+
+	if (!sg_len)
+		return NULL;
+	if (dir == DMA_DEV_TO_MEM) {
+		if (wd->cfg.src_addr_width != DMA_SLAVE_BUSWIDTH_4_BYTES)
+			return NULL;
+		fifo = wd->cfg.src_addr;
+	} else if (dir == DMA_MEM_TO_DEV) {
+		if (wd->cfg.dst_addr_width != DMA_SLAVE_BUSWIDTH_4_BYTES)
+			return NULL;
+		fifo = wd->cfg.dst_addr;
+	} else {
+		return NULL;
+	}
+
+	txd = wb_dma_txd_alloc(wd, sg_len, flags);
+	if (!txd)
+		return NULL;
+
+	for_each_sg(sgl, sg, sg_len, i) {
+		struct wb_dma_seg *seg = &txd->segs[i];
+
+		mem = wb_dma_mem_addr(wd, sg_dma_address(sg),
+				      sg_dma_len(sg));
+		if (!mem || !sg_dma_len(sg) || sg_dma_len(sg) % 4) {
+			kfree(txd);
+			return NULL;
+		}
+		seg->count = sg_dma_len(sg) / 4;
+		if (dir == DMA_DEV_TO_MEM) {
+			seg->src = fifo;
+			seg->dst = mem;
+			seg->dst_stride = 4;
+		} else {
+			seg->src = mem;
+			seg->dst = fifo;
+			seg->src_stride = 4;
+		}
+	}
+	return &txd->tx;
+}
+
+static int wb_dma_config(struct dma_chan *chan, struct dma_slave_config *cfg)
+{
+	struct wb_dma *wd = to_wb_dma(chan);
+	unsigned long flags;
+
+	spin_lock_irqsave(&wd->lock, flags);
+	wd->cfg = *cfg;
+	spin_unlock_irqrestore(&wd->lock, flags);
+	return 0;
+}
+
+static void wb_dma_issue_pending(struct dma_chan *chan)
+{
+	struct wb_dma *wd = to_wb_dma(chan);
+	unsigned long flags;
+
+	spin_lock_irqsave(&wd->lock, flags);
+	list_splice_tail_init(&wd->submitted, &wd->queue);
+	wb_dma_fill(wd);
+	spin_unlock_irqrestore(&wd->lock, flags);
+}
+
+static enum dma_status wb_dma_tx_status(struct dma_chan *chan,
+					dma_cookie_t cookie,
+					struct dma_tx_state *state)
+{
+	struct wb_dma *wd = to_wb_dma(chan);
+	struct wb_dma_txd *txd;
+	enum dma_status ret;
+	unsigned long flags;
+	u32 residue = 0;
+	unsigned int i;
+
+	spin_lock_irqsave(&wd->lock, flags);
+	/* For clients that poll without interrupts */
+	wb_dma_reclaim(wd);
+	ret = dma_async_is_complete(cookie, chan->completed_cookie,
+				    chan->cookie);
+	if (ret != DMA_COMPLETE) {
+		list_for_each_entry(txd, &wd->queue, node) {
+			if (txd->tx.cookie != cookie)
+				continue;
+			for (i = txd->n_done; i < txd->n_segs; i++)
+				residue += txd->segs[i].count * 4;
+			break;
+		}
+	}
+	dma_set_tx_state(state, chan->completed_cookie, chan->cookie, residue);
+	if (!list_empty(&wd->done))
+		tasklet_schedule(&wd->tasklet);
+	spin_unlock_irqrestore(&wd->lock, flags);
+
+	return ret;
+}
+
+/**
+ * Stop after the current descriptor (it can't be interrupted) and drop
+ * everything. Callbacks are not called. This doesn't wait: the transfers
+ * that were in the ring keep their buffers until the DMA has stopped, see
+ * wb_dma_synchronize().
+ */
+static int wb_dma_terminate_all(struct dma_chan *chan)
+{
+	struct wb_dma *wd = to_wb_dma(chan);
+	struct wb_dma_txd *txd, *tmp;
+	unsigned long flags;
+	LIST_HEAD(drop);
+
+	spin_lock_irqsave(&wd->lock, flags);
+	wd->write(wd, WB_DMA_CSR_STOP, WB_DMA_REG_DESC_CSR);
+	wb_dma_reclaim(wd);
+
+	list_splice_tail_init(&wd->submitted, &drop);
+	list_splice_tail_init(&wd->done, &drop);
+	list_for_each_entry_safe(txd, tmp, &wd->queue, node) {
+		if (txd->n_queued > txd->n_done)
+			list_move_tail(&txd->node, &wd->terminated);
+		else
+			list_move_tail(&txd->node, &drop);
+	}
+	wd->stopping = true;
+	if (!wb_dma_stopped(wd) && !timer_pending(&wd->poll_timer))
+		mod_timer(&wd->poll_timer, jiffies + wd->poll_period);
+	list_splice_tail_init(&wd->dropped, &drop);
+	spin_unlock_irqrestore(&wd->lock, flags);
+
+	wb_dma_txd_free_list(&drop);
+	return 0;
+}
+
+/**
+ * Wait up to WB_DMA_STOP_TIMEOUT_MS (a descriptor can be 2^32 words) for
+ * the DMA stopped by terminate_all, polling outside the lock. Returns
+ * false if it is still running.
+ */
+static bool wb_dma_wait_stopped(struct wb_dma *wd)
+{
+	unsigned long timeout = jiffies +
+				msecs_to_jiffies(WB_DMA_STOP_TIMEOUT_MS);
+	unsigned long flags;
+	bool stopped;
+	LIST_HEAD(drop);
+
+	for (;;) {
+		spin_lock_irqsave(&wd->lock, flags);
+		stopped = wb_dma_stopped(wd);
+		list_splice_tail_init(&wd->dropped, &drop);
+		spin_unlock_irqrestore(&wd->lock, flags);
+		if (stopped || time_after(jiffies, timeout))
+			break;
+		usleep_range(100, 200);
+	}
+	wb_dma_txd_free_list(&drop);
+	return stopped;
+}
+
+/**
+ * Wait for the DMA stopped by terminate_all. If it is still running, its
+ * transfers keep their buffers and are freed by the poll timer once it
+ * stops.
+ */
+static void wb_dma_synchronize(struct dma_chan *chan)
+{
+	struct wb_dma *wd = to_wb_dma(chan);
+
+	if (!wb_dma_wait_stopped(wd))
+		dev_err(wd->dev,
+			"still running after %u ms, its buffers are kept\n",
+			WB_DMA_STOP_TIMEOUT_MS);
+
+	tasklet_kill(&wd->tasklet);
+}
+
+static int wb_dma_alloc_chan_resources(struct dma_chan *chan)
+{
+	chan->cookie = DMA_MIN_COOKIE;
+	chan->completed_cookie = DMA_MIN_COOKIE;
+	return 0;
+}
+
+static void wb_dma_free_chan_resources(struct dma_chan *chan)
+{
+	wb_dma_terminate_all(chan);
+	wb_dma_synchronize(chan);
+}
+
+/**
+ * Wait for a chain left running by a previous user to end, after a stop
+ * request, so that it doesn't take the first write to 0x14 as a doorbell.
+ */
+static int wb_dma_wait_idle(struct wb_dma *wd)
+{
+	unsigned long timeout = jiffies +
+				msecs_to_jiffies(WB_DMA_STOP_TIMEOUT_MS);
+
+	while (wd->read(wd, WB_DMA_REG_DESC_CSR) & WB_DMA_CSR_RUNNING) {
+		if (time_after(jiffies, timeout)) {
+			dev_err(wd->dev, "still running after %u ms\n",
+				WB_DMA_STOP_TIMEOUT_MS);
+			return -EBUSY;
+		}
+		usleep_range(100, 200);
+	}
+	return 0;
+}
+
+static void wb_dma_free_ring(struct wb_dma *wd)
+{
+	dma_free_coherent(wd->dev, wd->n_slots * sizeof(*wd->ring),
+			  wd->ring, wd->ring_dma);
+}
+
+static int wb_dma_probe(struct platform_device *pdev)
+{
+	struct wb_dma_platform_data *pdata;
+	struct dma_device *dd;
+	struct wb_dma *wd;
+	struct resource *r;
+	int err;
+
+	pdata = pdev->dev.platform_data;
+	if (!pdata) {
+		dev_err(&pdev->dev, "missing platform data\n");
+		return -EINVAL;
+	}
+
+	wd = devm_kzalloc(&pdev->dev, sizeof(*wd), GFP_KERNEL);
+	if (!wd)
+		return -ENOMEM;
+	platform_set_drvdata(pdev, wd);
+	wd->dev = &pdev->dev;
+
+	r = platform_get_resource(pdev, IORESOURCE_MEM, 0);
+	wd->base = devm_ioremap_resource(&pdev->dev, r);
+	if (IS_ERR(wd->base))
+		return PTR_ERR(wd->base);
+
+	if (pdata->big_endian) {
+		wd->read = wb_dma_ioread32be;
+		wd->write = wb_dma_iowrite32be;
+	} else {
+		wd->read = wb_dma_ioread32;
+		wd->write = wb_dma_iowrite32;
+	}
+	wd->desc_be = pdata->desc_big_endian;
+	wd->dma_offset = pdata->dma_offset;
+
+	/* Let a previous user's chain end before the ring is reused */
+	wd->write(wd, WB_DMA_CSR_STOP, WB_DMA_REG_DESC_CSR);
+	err = wb_dma_wait_idle(wd);
+	if (err)
+		return err;
+
+	err = dma_set_mask_and_coherent(&pdev->dev, DMA_BIT_MASK(32));
+	if (err)
+		return err;
+	/*
+	 * Not devm: if the DMA can't be stopped on remove, the ring must
+	 * outlive the driver.
+	 */
+	wd->n_slots = pdata->n_desc ? pdata->n_desc : WB_DMA_N_DESC;
+	wd->ring = dma_alloc_coherent(&pdev->dev,
+				      wd->n_slots * sizeof(*wd->ring),
+				      &wd->ring_dma, GFP_KERNEL);
+	if (!wd->ring)
+		return -ENOMEM;
+	if (wd->ring_dma & (sizeof(*wd->ring) - 1) ||
+	    !wb_dma_mem_addr(wd, wd->ring_dma,
+			     wd->n_slots * sizeof(*wd->ring))) {
+		err = -EINVAL;
+		goto err_ring;
+	}
+	wd->slot_txd = devm_kcalloc(&pdev->dev, wd->n_slots,
+				    sizeof(*wd->slot_txd), GFP_KERNEL);
+	if (!wd->slot_txd) {
+		err = -ENOMEM;
+		goto err_ring;
+	}
+	wb_dma_ring_reset(wd);
+
+	spin_lock_init(&wd->lock);
+	INIT_LIST_HEAD(&wd->submitted);
+	INIT_LIST_HEAD(&wd->queue);
+	INIT_LIST_HEAD(&wd->done);
+	INIT_LIST_HEAD(&wd->terminated);
+	INIT_LIST_HEAD(&wd->dropped);
+#if KERNEL_VERSION(5, 9, 0) <= LINUX_VERSION_CODE
+	tasklet_setup(&wd->tasklet, wb_dma_tasklet);
+#else
+	tasklet_init(&wd->tasklet, wb_dma_tasklet, (unsigned long)wd);
+#endif
+#if KERNEL_VERSION(4, 15, 0) > LINUX_VERSION_CODE
+	setup_timer(&wd->poll_timer, wb_dma_poll, (unsigned long)wd);
+#else
+	timer_setup(&wd->poll_timer, wb_dma_poll, 0);
+#endif
+
+	wd->irq = platform_get_irq_optional(pdev, 0);
+	if (wd->irq == -EPROBE_DEFER) {
+		err = wd->irq;
+		goto err_ring;
+	}
+	if (wd->irq >= 0) {
+		err = devm_request_irq(&pdev->dev, wd->irq, wb_dma_irq_handler,
+				       0, dev_name(&pdev->dev), wd);
+		if (err)
+			goto err_ring;
+		wd->poll_period = msecs_to_jiffies(pdata->poll_ms ?
+						   pdata->poll_ms :
+						   WB_DMA_POLL_MS);
+	} else {
+		dev_info(&pdev->dev, "no IRQ, polling\n");
+		wd->poll_period = 1;
+	}
+
+	dd = &wd->dma;
+	dma_cap_set(DMA_MEMCPY, dd->cap_mask);
+	dma_cap_set(DMA_SLAVE, dd->cap_mask);
+	dd->dev = &pdev->dev;
+	dd->device_alloc_chan_resources = wb_dma_alloc_chan_resources;
+	dd->device_free_chan_resources = wb_dma_free_chan_resources;
+	dd->device_prep_dma_memcpy = wb_dma_prep_dma_memcpy;
+	dd->device_prep_slave_sg = wb_dma_prep_slave_sg;
+	dd->device_config = wb_dma_config;
+	dd->device_terminate_all = wb_dma_terminate_all;
+	dd->device_synchronize = wb_dma_synchronize;
+	dd->device_issue_pending = wb_dma_issue_pending;
+	dd->device_tx_status = wb_dma_tx_status;
+	dd->src_addr_widths = BIT(DMA_SLAVE_BUSWIDTH_4_BYTES);
+	dd->dst_addr_widths = BIT(DMA_SLAVE_BUSWIDTH_4_BYTES);
+	dd->directions = BIT(DMA_DEV_TO_MEM) | BIT(DMA_MEM_TO_DEV) |
+			 BIT(DMA_MEM_TO_MEM);
+	dd->residue_granularity = DMA_RESIDUE_GRANULARITY_SEGMENT;
+	dd->copy_align = DMAENGINE_ALIGN_4_BYTES;
+	INIT_LIST_HEAD(&dd->channels);
+	wd->chan.device = dd;
+	list_add_tail(&wd->chan.device_node, &dd->channels);
+
+	err = dma_async_device_register(dd);
+	if (err)
+		goto err_register;
+
+	dev_info(&pdev->dev, "%u descriptors, %s\n", wd->n_slots,
+		 wd->irq >= 0 ? "with IRQ" : "polling");
+
+	return 0;
+
+err_register:
+	if (wd->irq >= 0)
+		devm_free_irq(&pdev->dev, wd->irq, wd);
+	tasklet_kill(&wd->tasklet);
+err_ring:
+	wb_dma_free_ring(wd);
+	return err;
+}
+
+#if KERNEL_VERSION(6, 11, 0) <= LINUX_VERSION_CODE
+static void wb_dma_remove(struct platform_device *pdev)
+#else
+static int wb_dma_remove(struct platform_device *pdev)
+#endif
+{
+	struct wb_dma *wd = platform_get_drvdata(pdev);
+	bool stopped;
+
+	dma_async_device_unregister(&wd->dma);
+	wb_dma_terminate_all(&wd->chan);
+	stopped = wb_dma_wait_stopped(wd);
+	if (wd->irq >= 0)
+		devm_free_irq(&pdev->dev, wd->irq, wd);
+	timer_delete_sync(&wd->poll_timer);
+	tasklet_kill(&wd->tasklet);
+	/*
+	 * A DMA still running writes status into the ring and follows its
+	 * next pointers: leak the ring, and the transfers' buffers with it.
+	 */
+	if (stopped)
+		wb_dma_free_ring(wd);
+	else
+		dev_err(&pdev->dev,
+			"still running after %u ms, ring and buffers leaked\n",
+			WB_DMA_STOP_TIMEOUT_MS);
+#if KERNEL_VERSION(6, 11, 0) > LINUX_VERSION_CODE
+	return 0;
+#endif
+}
+
+static const struct platform_device_id wb_dma_id_table[] = {
+	{
+		.name = "wb-dma",
+	},
+	{
+		.name = "xwb-dma",
+	},
+	{ .name = "" }, /* last */
+};
+
+static struct platform_driver wb_dma_platform_driver = {
+	.probe		= wb_dma_probe,
+	.remove		= wb_dma_remove,
+	.driver	= {
+		.name	= WB_DMA_NAME,
+		.owner	= THIS_MODULE,
+	},
+	.id_table = wb_dma_id_table,
+};
+
+module_platform_driver(wb_dma_platform_driver);
+
+MODULE_DESCRIPTION("dmaengine driver for OHWR General-Cores Wishbone DMA");
+MODULE_LICENSE("GPL");
+MODULE_DEVICE_TABLE(platform, wb_dma_id_table);
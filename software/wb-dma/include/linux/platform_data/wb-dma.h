@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (C) 2026 CERN (www.cern.ch)
+ */
+
+#ifndef __WB_DMA_PDATA_H__
+#define __WB_DMA_PDATA_H__
+
+/**
+ * struct wb_dma_platform_data - General-Cores xwb_dma data
+ * @big_endian: registers are big endian
+ * @desc_big_endian: the DMA reads the descriptor words from host memory
+ *                   as big endian
+ * @dma_offset: Wishbone address at which the DMA masters see DMA (bus)
+ *              address 0 of the platform device. Memory buffers and the
+ *              descriptor ring must be below 4 GiB - dma_offset.
+ * @n_desc: descriptors in the ring, 64 if 0
+ * @poll_ms: period of the completion poll while transfers are pending,
+ *           10 if 0. Without an IRQ the poll runs every jiffy.
+ *
+ * IORESOURCE_MEM 0 is the register block. IORESOURCE_IRQ 0 is interrupt_o,
+ * usually through the HT-VIC. A missing IRQ is replaced by polling.
+ *
+ * The platform device must be able to do DMA (dma_mask and DMA ops, eg
+ * those of the PCI device the carrier driver creates it for).
+ */
+struct wb_dma_platform_data {
+	unsigned int big_endian;
+	unsigned int desc_big_endian;
+	u64 dma_offset;
+	unsigned int n_desc;
+	unsigned int poll_ms;
+};
+
+#endif
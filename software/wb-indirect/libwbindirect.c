@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+/*
+ * Copyright (c) 2026 CERN
+ *
+ * Block transfers through xwb_indirect, see wb-indirect.h.
+ *
+ * Every register access is a round trip through the host bridge, so the
+ * library keeps copies of ADDR and CTRL and only writes them when they
+ * change. ADDR auto-increments in the core; a block of n words costs at
+ * most n + 2 accesses (CTRL, ADDR, data) instead of 2n with an ADDR write
+ * per word, and the data accesses go to ascending window addresses.
+ */
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "wb-indirect.h"
+
+#define WBI_CTRL_UNKNOWN	0xffffffff
+#define WBI_REGS_SIZE		(WBI_REG_WINDOW + 4 * WBI_WINDOW_WORDS)
+
+static uint32_t mmio_readl(struct wbi *w, unsigned int reg)
+{
+	return *(volatile uint32_t *)(w->regs + reg);
+}
+
+static void mmio_writel(struct wbi *w, uint32_t val, unsigned int reg)
+{
+	*(volatile uint32_t *)(w->regs + reg) = val;
+}
+
+static const struct wbi_ops mmio_ops = {
+	.readl = mmio_readl,
+	.writel = mmio_writel,
+};
+
+static uint32_t rd(struct wbi *w, unsigned int reg)
+{
+	w->accesses++;
+	return w->ops->readl(w, reg);
+}
+
+static void wr(struct wbi *w, uint32_t val, unsigned int reg)
+{
+	w->accesses++;
+	w->ops->writel(w, val, reg);
+}
+
+void wbi_resync(struct wbi *w)
+{
+	w->addr_known = 0;
+	w->ctrl = WBI_CTRL_UNKNOWN;
+}
+
+void wbi_init(struct wbi *w, volatile void *regs, const struct wbi_ops *ops)
+{
+	w->ops = ops ? ops : &mmio_ops;
+	w->regs = regs;
+	w->prefetch = 0;
+	w->accesses = 0;
+	w->map = NULL;
+	w->maplen = 0;
+	wbi_resync(w);
+}
+
+int wbi_open(struct wbi *w, const char *dev, uint64_t offset)
+{
+	long pg = sysconf(_SC_PAGESIZE);
+	size_t len;
+	void *map;
+	int fd;
+
+	fd = open(dev, O_RDWR | O_SYNC);
+	if (fd < 0)
+		return -1;
+	len = (offset & (pg - 1)) + WBI_REGS_SIZE;
+	map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+		   offset & ~(uint64_t)(pg - 1));
+	close(fd);
+	if (map == MAP_FAILED)
+		return -1;
+	wbi_init(w, (volatile uint8_t *)map + (offset & (pg - 1)), NULL);
+	w->map = map;
+	w->maplen = len;
+	return 0;
+}
+
+void wbi_close(struct wbi *w)
+{
+	if (w->map)
+		munmap(w->map, w->maplen);
+	w->map = NULL;
+}
+
+static void set_ctrl(struct wbi *w, uint32_t ctrl)
+{
+	if (w->ctrl == ctrl)
+		return;
+	wr(w, ctrl, WBI_REG_CTRL);
+	w->ctrl = ctrl;
+}
+
+static void set_addr(struct wbi *w, uint32_t addr)
+{
+	if (w->addr_known && w->addr == addr)
+		return;
+	wr(w, addr, WBI_REG_ADDR);
+	w->addr = addr;
+	w->addr_known = 1;
+}
+
+uint32_t wbi_readl(struct wbi *w, uint32_t addr)
+{
+	uint32_t v;
+
+	/* No prefetch: the next word may be a register with side effects */
+	set_ctrl(w, WBI_CTRL_AUTOINC);
+	set_addr(w, addr);
+	v = rd(w, WBI_REG_DATA);
+	w->addr += 4;
+	return v;
+}
+
+void wbi_writel(struct wbi *w, uint32_t addr, uint32_t val)
+{
+	set_ctrl(w, WBI_CTRL_AUTOINC);
+	set_addr(w, addr);
+	wr(w, val, WBI_REG_DATA);
+	w->addr += 4;
+}
+
+void wbi_read_block(struct wbi *w, uint32_t addr, uint32_t *buf, size_t n)
+{
+	size_t i, j;
+
+	if (!n)
+		return;
+	set_ctrl(w, WBI_CTRL_AUTOINC | (w->prefetch ? WBI_CTRL_PREFETCH : 0));
+	set_addr(w, addr);
+	for (i = 0; i < n; i += WBI_WINDOW_WORDS)
+		for (j = 0; j < WBI_WINDOW_WORDS && i + j < n; j++)
+			buf[i + j] = rd(w, WBI_REG_WINDOW + 4 * j);
+	w->addr += 4 * n;
+}
+
+void wbi_write_block(struct wbi *w, uint32_t addr, const uint32_t *buf,
+		     size_t n)
+{
+	size_t i, j;
+
+	if (!n)
+		return;
+	/*
+	 * The CTRL value of the last block read can stay: the core drops
+	 * the prefetched word on writes.
+	 */
+	if (!(w->ctrl & WBI_CTRL_AUTOINC) || w->ctrl == WBI_CTRL_UNKNOWN)
+		set_ctrl(w, WBI_CTRL_AUTOINC);
+	set_addr(w, addr);
+	for (i = 0; i < n; i += WBI_WINDOW_WORDS)
+		for (j = 0; j < WBI_WINDOW_WORDS && i + j < n; j++)
+			wr(w, buf[i + j], WBI_REG_WINDOW + 4 * j);
+	w->addr += 4 * n;
+}
+
+void wbi_read_fifo(struct wbi *w, uint32_t addr, uint32_t *buf, size_t n)
+{
+	size_t i;
+
+	set_ctrl(w, 0);
+	set_addr(w, addr);
+	for (i = 0; i < n; i++)
+		buf[i] = rd(w, WBI_REG_DATA);
+}
+
+void wbi_write_fifo(struct wbi *w, uint32_t addr, const uint32_t *buf,
+		    size_t n)
+{
+	size_t i;
+
+	set_ctrl(w, 0);
+	set_addr(w, addr);
+	for (i = 0; i < n; i++)
+		wr(w, buf[i], WBI_REG_DATA);
+}
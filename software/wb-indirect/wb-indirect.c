@@ -0,0 +1,289 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (c) 2026 CERN
+ *
+ * Read and write the bus behind an xwb_indirect, a word or a whole file
+ * at a time, using libwbindirect's block transfers.
+ *
+ * With -t the core is replaced by a stand-in that behaves like
+ * xwb_indirect (ADDR, DATA, CTRL.AUTOINC, the window) on top of a sparse
+ * image file of big-endian words, for testing without hardware. -v
+ * reports the register accesses and the rate.
+ */
+
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "wb-indirect.h"
+
+#define CHUNK_WORDS 4096
+
+/* Stand-in core: the bus is an image file, w->priv its descriptor */
+struct standin {
+	int fd;
+	uint32_t addr, ctrl;
+};
+
+static uint32_t standin_bus_read(struct standin *s)
+{
+	uint32_t v;
+
+	if (pread(s->fd, &v, 4, s->addr) != 4)
+		return s->addr;		/* like the testbench slave */
+	return be32toh(v);
+}
+
+static void standin_bus_write(struct standin *s, uint32_t val)
+{
+	uint32_t v = htobe32(val);
+
+	if (pwrite(s->fd, &v, 4, s->addr) != 4)
+		perror("stand-in");
+}
+
+static uint32_t standin_readl(struct wbi *w, unsigned int reg)
+{
+	struct standin *s = w->priv;
+	uint32_t v;
+
+	switch (reg) {
+	case WBI_REG_ADDR:
+		return s->addr;
+	case WBI_REG_CTRL:
+		return s->ctrl;
+	case WBI_REG_DATA:
+		break;
+	default:
+		if (reg < WBI_REG_WINDOW ||
+		    reg >= WBI_REG_WINDOW + 4 * WBI_WINDOW_WORDS)
+			return 0;
+	}
+	v = standin_bus_read(s);
+	if (s->ctrl & WBI_CTRL_AUTOINC)
+		s->addr += 4;
+	return v;
+}
+
+static void standin_writel(struct wbi *w, uint32_t val, unsigned int reg)
+{
+	struct standin *s = w->priv;
+
+	switch (reg) {
+	case WBI_REG_ADDR:
+		s->addr = val;
+		return;
+	case WBI_REG_CTRL:
+		s->ctrl = val & (WBI_CTRL_AUTOINC | WBI_CTRL_PREFETCH);
+		return;
+	case WBI_REG_DATA:
+		break;
+	default:
+		if (reg < WBI_REG_WINDOW ||
+		    reg >= WBI_REG_WINDOW + 4 * WBI_WINDOW_WORDS)
+			return;
+	}
+	standin_bus_write(s, val);
+	if (s->ctrl & WBI_CTRL_AUTOINC)
+		s->addr += 4;
+}
+
+static const struct wbi_ops standin_ops = {
+	.readl = standin_readl,
+	.writel = standin_writel,
+};
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void help(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [options] -d <device> <command>\n"
+		"       %s [options] -t <image> <command>\n"
+		"\n"
+		"Commands:\n"
+		"  read <addr> [<n>]          print n words (default 1)\n"
+		"  write <addr> <val>...      write consecutive words\n"
+		"  load <addr> <file>         write the words of <file>\n"
+		"  dump <addr> <n> <file>     save n words to <file>\n"
+		"\n"
+		"  -d <device>   /dev/mem or a PCI resource file\n"
+		"  -a <offset>   offset of the xwb_indirect registers in <device>\n"
+		"  -t <image>    stand-in core over an image file, for testing\n"
+		"  -F            all words at the same address (a FIFO)\n"
+		"  -P            no prefetch on block reads (side effects)\n"
+		"  -l            files hold little-endian words (default big)\n"
+		"  -v            report register accesses and rate on stderr\n",
+		name, name);
+	exit(1);
+}
+
+static void xfer(struct wbi *w, int fifo, int wr, uint32_t addr,
+		 uint32_t *buf, size_t n)
+{
+	if (fifo && wr)
+		wbi_write_fifo(w, addr, buf, n);
+	else if (fifo)
+		wbi_read_fifo(w, addr, buf, n);
+	else if (wr)
+		wbi_write_block(w, addr, buf, n);
+	else
+		wbi_read_block(w, addr, buf, n);
+}
+
+/* load/dump, CHUNK_WORDS at a time */
+static int file_cmd(struct wbi *w, int wr, uint32_t addr, size_t n,
+		    const char *file, int fifo, int le, size_t *done)
+{
+	uint32_t buf[CHUNK_WORDS];
+	size_t i, k;
+	ssize_t len;
+	int fd;
+
+	fd = wr ? open(file, O_RDONLY) :
+		  open(file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		perror(file);
+		return -1;
+	}
+	*done = 0;
+	for (;;) {
+		k = CHUNK_WORDS;
+		if (!wr) {
+			if (*done == n)
+				break;
+			if (n - *done < k)
+				k = n - *done;
+			xfer(w, fifo, 0, addr, buf, k);
+			for (i = 0; i < k; i++)
+				buf[i] = le ? htole32(buf[i]) : htobe32(buf[i]);
+			if (write(fd, buf, 4 * k) != (ssize_t)(4 * k)) {
+				perror(file);
+				break;
+			}
+		} else {
+			len = read(fd, buf, sizeof(buf));
+			if (len < 0) {
+				perror(file);
+				break;
+			}
+			if (len == 0)
+				break;
+			/* A partial last word is padded with zeros */
+			if (len & 3)
+				memset((uint8_t *)buf + len, 0, 4 - (len & 3));
+			k = (len + 3) / 4;
+			for (i = 0; i < k; i++)
+				buf[i] = le ? le32toh(buf[i]) : be32toh(buf[i]);
+			xfer(w, fifo, 1, addr, buf, k);
+		}
+		if (!fifo)
+			addr += 4 * k;
+		*done += k;
+	}
+	close(fd);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *dev = NULL, *image = NULL, *cmd;
+	struct standin s = { .ctrl = WBI_CTRL_AUTOINC };
+	uint64_t offset = 0;
+	int fifo = 0, prefetch = 1, le = 0, verbose = 0, ret = 0, c;
+	size_t n = 0, i;
+	struct wbi w;
+	uint32_t addr, *buf;
+	double t0;
+
+	while ((c = getopt(argc, argv, "d:a:t:FPlvh")) != -1) {
+		switch (c) {
+		case 'd': dev = optarg; break;
+		case 'a': offset = strtoull(optarg, NULL, 0); break;
+		case 't': image = optarg; break;
+		case 'F': fifo = 1; break;
+		case 'P': prefetch = 0; break;
+		case 'l': le = 1; break;
+		case 'v': verbose = 1; break;
+		default: help(argv[0]);
+		}
+	}
+	if (!!dev == !!image || argc - optind < 2)
+		help(argv[0]);
+	cmd = argv[optind];
+	addr = strtoul(argv[optind + 1], NULL, 0);
+	argv += optind + 2;
+	argc -= optind + 2;
+
+	if (image) {
+		s.fd = open(image, O_RDWR | O_CREAT, 0644);
+		if (s.fd < 0) {
+			perror(image);
+			return 1;
+		}
+		wbi_init(&w, NULL, &standin_ops);
+		w.priv = &s;
+	} else if (wbi_open(&w, dev, offset)) {
+		perror(dev);
+		return 1;
+	}
+	w.prefetch = prefetch;
+
+	t0 = now();
+	if (!strcmp(cmd, "read") && argc <= 1) {
+		n = argc ? strtoul(argv[0], NULL, 0) : 1;
+		buf = malloc(4 * n + 1);
+		if (!buf) {
+			perror("malloc");
+			return 1;
+		}
+		xfer(&w, fifo, 0, addr, buf, n);
+		for (i = 0; i < n; i++)
+			printf("%08x: %08x\n", fifo ? addr : addr + 4 * (uint32_t)i,
+			       buf[i]);
+		free(buf);
+	} else if (!strcmp(cmd, "write") && argc >= 1) {
+		n = argc;
+		buf = malloc(4 * n);
+		if (!buf) {
+			perror("malloc");
+			return 1;
+		}
+		for (i = 0; i < n; i++)
+			buf[i] = strtoul(argv[i], NULL, 0);
+		xfer(&w, fifo, 1, addr, buf, n);
+		free(buf);
+	} else if (!strcmp(cmd, "load") && argc == 1) {
+		ret = file_cmd(&w, 1, addr, 0, argv[0], fifo, le, &n);
+	} else if (!strcmp(cmd, "dump") && argc == 2) {
+		ret = file_cmd(&w, 0, addr, strtoul(argv[0], NULL, 0), argv[1],
+			       fifo, le, &n);
+	} else {
+		help(argv[0]);
+	}
+
+	if (verbose) {
+		double t = now() - t0;
+
+		fprintf(stderr, "%zu words, %llu register accesses, "
+			"%.0f words/s\n", n, w.accesses, t > 0 ? n / t : 0.0);
+	}
+	if (image)
+		close(s.fd);
+	else
+		wbi_close(&w);
+	return ret ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (c) 2026 CERN
+ *
+ * Block transfers through xwb_indirect (wb_indirect_regs.cheby).
+ */
+
+#ifndef __WB_INDIRECT_H__
+#define __WB_INDIRECT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* xwb_indirect registers */
+#define WBI_REG_ADDR		0x00
+#define WBI_REG_DATA		0x04
+#define WBI_REG_CTRL		0x08
+#define WBI_REG_WINDOW		0x40	/* 16 aliases of DATA */
+#define WBI_WINDOW_WORDS	16
+
+#define WBI_CTRL_AUTOINC	(1 << 0)
+#define WBI_CTRL_PREFETCH	(1 << 1)
+
+struct wbi;
+
+/* Register access, mmio by default. A stand-in can replace it. */
+struct wbi_ops {
+	uint32_t (*readl)(struct wbi *w, unsigned int reg);
+	void (*writel)(struct wbi *w, uint32_t val, unsigned int reg);
+};
+
+struct wbi {
+	const struct wbi_ops *ops;
+	volatile uint8_t *regs;
+	void *priv;
+
+	/*
+	 * What the core's ADDR and CTRL hold, so that they are only written
+	 * when needed: a block that follows the previous one costs no ADDR
+	 * write at all.
+	 */
+	uint32_t addr, ctrl;
+	int addr_known;
+
+	/*
+	 * Use CTRL.PREFETCH for block reads, default off: a block read then
+	 * also reads the word after the block. Set it for memories only.
+	 */
+	int prefetch;
+
+	unsigned long long accesses;	/* register accesses, for statistics */
+
+	/* wbi_open() mapping */
+	void *map;
+	size_t maplen;
+};
+
+/* Map the registers at offset of dev (/dev/mem, PCI resource) */
+int wbi_open(struct wbi *w, const char *dev, uint64_t offset);
+void wbi_close(struct wbi *w);
+
+/* Use registers mapped by the caller, or a stand-in (regs NULL, ops set) */
+void wbi_init(struct wbi *w, volatile void *regs, const struct wbi_ops *ops);
+
+/* Forget the ADDR/CTRL shadows, eg after another user of the core */
+void wbi_resync(struct wbi *w);
+
+/* Single accesses */
+uint32_t wbi_readl(struct wbi *w, uint32_t addr);
+void wbi_writel(struct wbi *w, uint32_t addr, uint32_t val);
+
+/*
+ * n words from/to consecutive addresses. One ADDR write (none if the
+ * previous transfer ended at addr), then the data through the window, in
+ * ascending addresses so that the host bridge can merge them into bursts.
+ */
+void wbi_read_block(struct wbi *w, uint32_t addr, uint32_t *buf, size_t n);
+void wbi_write_block(struct wbi *w, uint32_t addr, const uint32_t *buf,
+		     size_t n);
+
+/* n words from/to the same address (a FIFO), with CTRL.AUTOINC cleared */
+void wbi_read_fifo(struct wbi *w, uint32_t addr, uint32_t *buf, size_t n);
+void wbi_write_fifo(struct wbi *w, uint32_t addr, const uint32_t *buf,
+		    size_t n);
+
+#endif /* __WB_INDIRECT_H__ */
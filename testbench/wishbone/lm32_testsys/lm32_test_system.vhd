@@ -45,9 +45,14 @@ architecture rtl of lm32_test_system is
      2 => x"f0000000");
 
   signal owr_en_slv, owr_in_slv : std_logic_vector(0 downto 0);
+
+  -- irq 0: UART RX, irq 1: UART TX (see sw/uart.c)
+  signal irq : std_logic_vector(31 downto 0);
   
 begin  -- rtl
 
+  irq(31 downto 2) <= (others => '0');
+
   U_CPU : xwb_lm32
     generic map (
       g_profile => "medium",
@@ -55,7 +60,7 @@ begin  -- rtl
     port map (
       clk_sys_i => clk_sys_i,
       rst_n_i   => rst_n_i,
-      irq_i     => x"00000000",
+      irq_i     => irq,
       dwb_o     => cnx_slave_in(0),
       dwb_i     => cnx_slave_out(0),
       iwb_o     => cnx_slave_in(1),
@@ -124,6 +129,9 @@ begin  -- rtl
 
   U_UART : xwb_simple_uart
     generic map (
+      g_with_physical_uart_fifo => true,
+      g_tx_fifo_size            => 16,
+      g_rx_fifo_size            => 16,
       g_interface_mode      => PIPELINED,
       g_address_granularity => BYTE)
     port map (
@@ -131,6 +139,8 @@ begin  -- rtl
       rst_n_i    => rst_n_i,
       slave_i    => cnx_master_out(2),
       slave_o    => cnx_master_in(2),
+      int_o      => irq(0),
+      int_tx_o   => irq(1),
       uart_rxd_i => rxd_i,
       uart_txd_o => txd_o);
 
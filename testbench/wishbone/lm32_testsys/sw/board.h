@@ -7,5 +7,27 @@ static inline int delay(int x)
 {
   while(x--) asm volatile("nop");
 }
+
+/* Clear IE, returning the previous value for irq_restore() */
+static inline unsigned int irq_save()
+{
+  unsigned int ie, tmp;
+
+  asm volatile ("rcsr %0, ie\n"
+                "andi %1, %0, 0xfffe\n"
+                "wcsr ie, %1" : "=&r"(ie), "=&r"(tmp) : : "memory");
+  return ie;
+}
+
+static inline void irq_restore(unsigned int ie)
+{
+  asm volatile ("wcsr ie, %0" : : "r"(ie) : "memory");
+}
+
+/* Set IE, once _irq_entry() can serve every line unmasked in im */
+static inline void irq_enable()
+{
+  irq_restore(irq_save() | 1);
+}
   
 #endif
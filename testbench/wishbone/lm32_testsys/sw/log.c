@@ -0,0 +1,188 @@
+#include <stdarg.h>
+
+#include "inttypes.h"
+#include "board.h"
+#include "uart.h"
+#include "log.h"
+
+#if LOG_RING_SIZE & (LOG_RING_SIZE - 1)
+#error LOG_RING_SIZE must be a power of 2
+#endif
+
+uint32_t log_ring[LOG_RING_SIZE];
+volatile unsigned int log_head, log_tail;
+volatile unsigned int log_drops;
+
+/* byte of log_ring[log_tail] that log_drain() sends next */
+static unsigned int log_byte;
+
+/*
+ * Writers may be interrupted by other writers (ISRs), so a record is put
+ * in with IE off; a record that does not fit is dropped whole.
+ */
+#define LOG_BEGIN(n)							\
+	unsigned int ie = irq_save(), h = log_head;			\
+	if (LOG_RING_SIZE - (h - log_tail) < (n)) {			\
+		log_drops++;						\
+		irq_restore(ie);					\
+		return;							\
+	}
+#define LOG_PUT(v) log_ring[h++ & (LOG_RING_SIZE - 1)] = (v)
+#define LOG_END()							\
+	log_head = h;							\
+	irq_restore(ie)
+
+void log_write0(uint32_t hdr)
+{
+	LOG_BEGIN(1);
+	LOG_PUT(hdr);
+	LOG_END();
+}
+
+void log_write1(uint32_t hdr, uint32_t a0)
+{
+	LOG_BEGIN(2);
+	LOG_PUT(hdr); LOG_PUT(a0);
+	LOG_END();
+}
+
+void log_write2(uint32_t hdr, uint32_t a0, uint32_t a1)
+{
+	LOG_BEGIN(3);
+	LOG_PUT(hdr); LOG_PUT(a0); LOG_PUT(a1);
+	LOG_END();
+}
+
+void log_write3(uint32_t hdr, uint32_t a0, uint32_t a1, uint32_t a2)
+{
+	LOG_BEGIN(4);
+	LOG_PUT(hdr); LOG_PUT(a0); LOG_PUT(a1); LOG_PUT(a2);
+	LOG_END();
+}
+
+void log_write4(uint32_t hdr, uint32_t a0, uint32_t a1, uint32_t a2,
+		uint32_t a3)
+{
+	LOG_BEGIN(5);
+	LOG_PUT(hdr); LOG_PUT(a0); LOG_PUT(a1); LOG_PUT(a2); LOG_PUT(a3);
+	LOG_END();
+}
+
+void log_write5(uint32_t hdr, uint32_t a0, uint32_t a1, uint32_t a2,
+		uint32_t a3, uint32_t a4)
+{
+	LOG_BEGIN(6);
+	LOG_PUT(hdr); LOG_PUT(a0); LOG_PUT(a1); LOG_PUT(a2); LOG_PUT(a3);
+	LOG_PUT(a4);
+	LOG_END();
+}
+
+void log_write6(uint32_t hdr, uint32_t a0, uint32_t a1, uint32_t a2,
+		uint32_t a3, uint32_t a4, uint32_t a5)
+{
+	LOG_BEGIN(7);
+	LOG_PUT(hdr); LOG_PUT(a0); LOG_PUT(a1); LOG_PUT(a2); LOG_PUT(a3);
+	LOG_PUT(a4); LOG_PUT(a5);
+	LOG_END();
+}
+
+static inline int is_digit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+/*
+ * printf-compatible entry for formats that are not literals. It only
+ * counts the arguments, the format itself stays in the image and is
+ * sent by address. A conversion takes one argument, plus one for each *
+ * in its width or precision. Returns the number of arguments logged.
+ */
+int mprintf(char const *format, ...)
+{
+	uint32_t a[LOG_MAX_ARGS];
+	unsigned int ie, h;
+	const char *p;
+	va_list ap;
+	int n = 0, i, k;
+
+	va_start(ap, format);
+	for (p = format; *p; p++) {
+		if (*p != '%')
+			continue;
+		if (*++p == '%')
+			continue;
+		/* %[flags][width][.precision][length]conversion */
+		k = 1;
+		while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' ||
+		       *p == '0')
+			p++;
+		if (*p == '*')
+			k++, p++;
+		else
+			while (is_digit(*p))
+				p++;
+		if (*p == '.') {
+			if (*++p == '*')
+				k++, p++;
+			else
+				while (is_digit(*p))
+					p++;
+		}
+		while (*p == 'h' || *p == 'l' || *p == 'z' || *p == 'j' ||
+		       *p == 't')
+			p++;
+		if (!*p || n + k > LOG_MAX_ARGS)
+			break;
+		while (k--)
+			a[n++] = va_arg(ap, uint32_t);
+	}
+	va_end(ap);
+
+	ie = irq_save();
+	h = log_head;
+	if (LOG_RING_SIZE - (h - log_tail) < 2 + n) {
+		log_drops++;
+		irq_restore(ie);
+		return 0;
+	}
+	LOG_PUT((LOG_MAGIC << 24) | LOG_F_ABS | (n << 16));
+	LOG_PUT((uint32_t)format);
+	for (i = 0; i < n; i++)
+		LOG_PUT(a[i]);
+	LOG_END();
+
+	return n;
+}
+
+int log_drain()
+{
+	unsigned int tail = log_tail;
+	int sent = 0, k;
+
+	while (tail != log_head) {
+		uint32_t w = log_ring[tail & (LOG_RING_SIZE - 1)];
+		uint8_t b[4];
+
+		b[0] = w >> 24;
+		b[1] = w >> 16;
+		b[2] = w >> 8;
+		b[3] = w;
+		k = uart_write_nb(b + log_byte, 4 - log_byte);
+		sent += k;
+		log_byte += k;
+		if (log_byte < 4)
+			break;
+		log_byte = 0;
+		tail++;
+	}
+	log_tail = tail;
+
+	return sent;
+}
+
+void log_flush()
+{
+	while (log_tail != log_head)
+		log_drain();
+	uart_flush();
+}
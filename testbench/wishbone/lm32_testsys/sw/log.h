@@ -0,0 +1,76 @@
+#ifndef __LOG_H
+#define __LOG_H
+
+#include "inttypes.h"
+
+/*
+ * Binary logger: LOG("x=%d y=%x\n", x, y) does no formatting on the CPU.
+ * It stores a header word and the raw 32-bit arguments in a RAM ring, and
+ * log_drain() moves the ring to the UART (and so to the VUART) in the
+ * background. tools/logdecode.py rebuilds the text from the ELF.
+ *
+ * The format strings go to the .logfmt section, which ram.ld links at
+ * address 0 and does not load, so they cost no RAM and a format is
+ * identified by its address. Record layout, big-endian words:
+ *
+ *   header: [31:24] LOG_MAGIC, [23] LOG_F_ABS, [19:16] number of args,
+ *           [15:0] format address in .logfmt
+ *   LOG_F_ABS only: absolute address of a format in the loaded image
+ *   args:   one word each
+ *
+ * Arguments are passed as words: %d %i %u %x %X %o %c %p work, %s only
+ * for strings that are in the ELF (constants). No 64-bit or float args.
+ * Bytes that do not start with LOG_MAGIC are passed through as text by
+ * the decoder, so plain uart_write_byte() output can share the line as
+ * long as it is not written in the middle of log_drain().
+ */
+
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE 256		/* words, power of 2 */
+#endif
+
+#ifndef LOG_FMT_BASE
+#define LOG_FMT_BASE 0			/* link address of .logfmt */
+#endif
+
+#define LOG_MAGIC 0xa5
+#define LOG_F_ABS (1 << 23)
+#define LOG_MAX_ARGS 6
+
+extern uint32_t log_ring[LOG_RING_SIZE];
+extern volatile unsigned int log_head, log_tail;
+extern volatile unsigned int log_drops;
+
+void log_write0(uint32_t hdr);
+void log_write1(uint32_t hdr, uint32_t a0);
+void log_write2(uint32_t hdr, uint32_t a0, uint32_t a1);
+void log_write3(uint32_t hdr, uint32_t a0, uint32_t a1, uint32_t a2);
+void log_write4(uint32_t hdr, uint32_t a0, uint32_t a1, uint32_t a2,
+		uint32_t a3);
+void log_write5(uint32_t hdr, uint32_t a0, uint32_t a1, uint32_t a2,
+		uint32_t a3, uint32_t a4);
+void log_write6(uint32_t hdr, uint32_t a0, uint32_t a1, uint32_t a2,
+		uint32_t a3, uint32_t a4, uint32_t a5);
+
+/* Move as much of the ring as fits to the UART TX ring, returns bytes */
+int log_drain();
+/* Block until the ring is empty and the UART has taken everything */
+void log_flush();
+
+#define __LOG_CAT(a, b) a ## b
+#define __LOG_FN(n) __LOG_CAT(log_write, n)
+#define __LOG_NARGS(...) __LOG_NARGS_(0, ## __VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define __LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, n, ...) n
+
+#define __LOG_HDR(fmt, n) ({						\
+	static const char __fmt[]					\
+		__attribute__((section(".logfmt"), used)) = fmt;	\
+	(LOG_MAGIC << 24) | ((n) << 16) |				\
+		((uint32_t)__fmt - LOG_FMT_BASE);			\
+	})
+
+#define LOG(fmt, ...)							\
+	__LOG_FN(__LOG_NARGS(__VA_ARGS__))(				\
+		__LOG_HDR(fmt, __LOG_NARGS(__VA_ARGS__)), ## __VA_ARGS__)
+
+#endif
@@ -2,12 +2,18 @@
 //#include <stdint.h>
 
 #include "gpio.h"
+#include "uart.h"
+#include "log.h"
 
-void _irq_entry(){}
+void _irq_entry()
+{
+	uart_irq();
+}
 
 int main(void)
 {
 	uart_init();
+	irq_enable();
 	uart_write_byte('U');
 	uart_write_byte('U');
 	uart_write_byte('U');
@@ -16,6 +22,10 @@ int main(void)
 	uart_write_byte('U');
 	uart_write_byte('U');
 	uart_write_byte('U');
+	uart_flush();
+
+	LOG("\nlm32_testsys up, log ring %d words\n", LOG_RING_SIZE);
+	log_flush();
 
 /*	gpio_dir(1,1);
 	for(;;)
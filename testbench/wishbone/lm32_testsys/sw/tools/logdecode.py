@@ -0,0 +1,181 @@
+#!/usr/bin/env python
+##-------------------------------------------------------------------------------
+## Decoder for the binary log of the LM32 test system software (log.h).
+##
+## Reads the UART byte stream, looks the format strings up in the ELF the
+## firmware was built from and prints the text. Bytes outside of log
+## records are copied as they are.
+##
+## Usage:
+##   python logdecode.py main.elf [stream]
+##
+## stream is a file or a raw serial device (stty -F /dev/ttyUSB0 raw ...),
+## standard input by default.
+##-------------------------------------------------------------------------------
+
+from __future__ import print_function
+
+import argparse
+import re
+import struct
+import sys
+
+LOG_MAGIC = 0xa5
+LOG_F_ABS = 1 << 23
+
+SHT_NOBITS = 8
+SHF_ALLOC = 2
+
+
+class Elf(object):
+    """Just enough of an ELF reader to find strings by address."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        d = self.data
+        if d[:4] != b'\x7fELF':
+            raise ValueError('{}: not an ELF file'.format(path))
+        is64 = d[4] == 2 or d[4:5] == b'\x02'
+        end = '<' if (d[5] == 1 or d[5:6] == b'\x01') else '>'
+        if is64:
+            shoff, = struct.unpack_from(end + 'Q', d, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from(end + 'HHH', d, 0x3a)
+            shfmt = end + 'IIQQQQIIQQ'
+        else:
+            shoff, = struct.unpack_from(end + 'I', d, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from(end + 'HHH', d, 0x2e)
+            shfmt = end + 'IIIIIIIIII'
+        raw = [struct.unpack_from(shfmt, d, shoff + i * shentsize)
+               for i in range(shnum)]
+        strtab = raw[shstrndx][4]
+        # name, type, flags, addr, offset, size
+        self.sections = [(self.cstr(strtab + s[0]), s[1], s[2], s[3], s[4], s[5])
+                         for s in raw]
+
+    def cstr(self, offs):
+        end = self.data.index(b'\0', offs)
+        return self.data[offs:end].decode('latin-1')
+
+    def section(self, name):
+        for s in self.sections:
+            if s[0] == name:
+                return s
+        return None
+
+    def string_at(self, addr):
+        """String at a target address, None if it is not in the image."""
+        for name, typ, flags, base, offs, size in self.sections:
+            if (flags & SHF_ALLOC and typ != SHT_NOBITS and
+                    base <= addr < base + size):
+                return self.cstr(offs + addr - base)
+        return None
+
+
+# %[flags][width][.precision][length]conversion, * takes an argument
+CONV = re.compile(r'%([-+ #0]*)(\*|\d*)(?:\.(\*|\d*))?(?:hh|h|ll|l|z|j|t)?'
+                  r'([diouxXcsp%])')
+
+
+def signed(v):
+    return v - (1 << 32) if v & 0x80000000 else v
+
+
+def cformat(elf, fmt, args):
+    args = list(args)
+    out = []
+    pos = 0
+    for m in CONV.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, prec, conv = m.groups()
+        if conv == '%':
+            out.append('%')
+            continue
+        if width == '*':
+            # like C, a negative width is the - flag
+            w = signed(args.pop(0)) if args else 0
+            flags += '-' if w < 0 else ''
+            width = str(abs(w)) if w else ''
+        if prec == '*':
+            # and a negative precision is no precision
+            p = signed(args.pop(0)) if args else 0
+            prec = str(p) if p >= 0 else None
+        v = args.pop(0) if args else 0
+        spec = '%' + flags + width + ('.' + prec if prec is not None else '')
+        if conv in 'di':
+            out.append((spec + 'd') % signed(v))
+        elif conv == 'u':
+            out.append((spec + 'd') % v)
+        elif conv == 'o':
+            s = (spec.replace('#', '') + 'o') % v
+            out.append('0' + s.lstrip() if '#' in flags and v else s)
+        elif conv in 'xX':
+            out.append((spec + conv) % v)
+        elif conv == 'c':
+            out.append((spec + 'c') % chr(v & 0xff))
+        elif conv == 's':
+            s = elf.string_at(v)
+            out.append((spec + 's') % (s if s is not None else '<0x%08x>' % v))
+        elif conv == 'p':
+            out.append('0x%08x' % v)
+    out.append(fmt[pos:])
+    return ''.join(out)
+
+
+def decode(elf, stream, out):
+    fmtsec = elf.section('.logfmt')
+    buf = bytearray()
+
+    def need(n):
+        while len(buf) < n:
+            c = stream.read(n - len(buf))
+            if not c:
+                return False
+            buf.extend(c)
+        return True
+
+    while need(1):
+        if buf[0] != LOG_MAGIC:
+            out.write(chr(buf.pop(0)))
+            continue
+        if not need(4):
+            break
+        hdr, = struct.unpack_from('>I', bytes(buf[:4]))
+        nargs = (hdr >> 16) & 0xf
+        nwords = 1 + nargs + (1 if hdr & LOG_F_ABS else 0)
+        if not need(4 * nwords):
+            break
+        words = struct.unpack('>%dI' % nwords, bytes(buf[:4 * nwords]))
+        del buf[:4 * nwords]
+        if hdr & LOG_F_ABS:
+            fmt = elf.string_at(words[1])
+            args = words[2:]
+        else:
+            fmt = (elf.cstr(fmtsec[4] + (hdr & 0xffff))
+                   if fmtsec and (hdr & 0xffff) < fmtsec[5] else None)
+            args = words[1:]
+        if fmt is None:
+            out.write('<log: unknown format 0x%08x>\n' % hdr)
+            continue
+        out.write(cformat(elf, fmt, args))
+        out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Decode the binary log of the LM32 test system')
+    parser.add_argument('elf', help='ELF file of the running firmware')
+    parser.add_argument('stream', nargs='?', help='log stream (default stdin)')
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    if args.stream:
+        with open(args.stream, 'rb', 0) as f:
+            decode(elf, f, sys.stdout)
+    else:
+        decode(elf, getattr(sys.stdin, 'buffer', sys.stdin), sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
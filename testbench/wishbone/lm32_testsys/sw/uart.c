@@ -1,5 +1,6 @@
 #include "inttypes.h"
 #include "uart.h"
+#include "board.h"
 
 #define CPU_CLOCK 1000000
 #define UART_BAUDRATE 10000
@@ -8,29 +9,203 @@
 #include "wb_uart.h"
 
 #define CALC_BAUD(baudrate) (((((unsigned long long)baudrate*8ULL)<<(16-7))+(CPU_CLOCK>>8))/(CPU_CLOCK>>7))
- 
+
+#if (UART_TX_RING_SIZE & (UART_TX_RING_SIZE - 1)) || (UART_RX_RING_SIZE & (UART_RX_RING_SIZE - 1))
+#error UART ring sizes must be powers of 2
+#endif
+
+/*
+ * TX and RX go through rings in RAM, so writers don't wait for the line.
+ * TX: a writer queues into the ring and enables the TX interrupt, the ISR
+ * moves bytes to the UART until the TX FIFO is full (SR.TX_BUSY, which is
+ * TX FIFO full with g_WITH_PHYSICAL_UART_FIFO) and masks the interrupt
+ * again once the ring is empty. RX: the ISR moves all received bytes into
+ * the ring. The indices are free running. tx_head is reserved, filled and
+ * published with interrupts off, as writers may be ISRs; the other ones
+ * are written by one side only.
+ */
+
 static volatile struct UART_WB *uart = (volatile struct UART_WB *) BASE_UART;
 
+static uint8_t tx_ring[UART_TX_RING_SIZE];
+static uint8_t rx_ring[UART_RX_RING_SIZE];
+static volatile unsigned int tx_head, tx_tail; /* head: writers, tail: ISR */
+static volatile unsigned int rx_head, rx_tail; /* head: ISR, tail: readers */
+
+volatile unsigned int uart_rx_overflows;
+
+static inline void irq_mask(unsigned int bits, int on)
+{
+	unsigned int ie = irq_save(), im;
+
+	asm volatile ("rcsr %0, im" : "=r"(im));
+	im = on ? (im | bits) : (im & ~bits);
+	asm volatile ("wcsr im, %0" : : "r"(im));
+	irq_restore(ie);
+}
+
+/*
+ * Clear pending bits: ip is sticky, only a write of 1 clears a bit. Done
+ * before serving, so a line that asserts again meanwhile stays pending.
+ */
+static inline void irq_clear(unsigned int bits)
+{
+	unsigned int ip;
+
+	asm volatile ("rcsr %0, ip\n"
+		      "and  %0, %0, %1\n"
+		      "wcsr ip, %0" : "=&r"(ip) : "r"(bits));
+}
+
+/* Move queued bytes to the UART while it takes them, interrupts off */
+static void uart_tx_refill()
+{
+	unsigned int tail = tx_tail;
+
+	while (tail != tx_head && !(uart->SR & UART_SR_TX_BUSY))
+		uart->TDR = tx_ring[tail++ & (UART_TX_RING_SIZE - 1)];
+	tx_tail = tail;
+}
+
+static void uart_rx_drain()
+{
+	unsigned int head = rx_head;
+
+	while (uart->SR & UART_SR_RX_RDY) {
+		uint8_t c = uart->RDR & 0xff;
+
+		if (head - rx_tail < UART_RX_RING_SIZE)
+			rx_ring[head++ & (UART_RX_RING_SIZE - 1)] = c;
+		else
+			uart_rx_overflows++;
+	}
+	rx_head = head;
+}
+
 void uart_init()
 {
 	uart->BCR = CALC_BAUD(UART_BAUDRATE);
+	uart->CR = UART_CR_RX_FIFO_PURGE | UART_CR_TX_FIFO_PURGE;
+
+	tx_head = tx_tail = 0;
+	rx_head = rx_tail = 0;
+
+	/* RX interrupt on, TX interrupt only while the TX ring has data */
+	irq_mask(1 << UART_IRQ_TX, 0);
+	irq_mask(1 << UART_IRQ_RX, 1);
 }
 
-void uart_write_byte(unsigned char x)
+void uart_irq()
 {
-	while( uart->SR & UART_SR_TX_BUSY);
+	irq_clear((1 << UART_IRQ_RX) | (1 << UART_IRQ_TX));
+	uart_rx_drain();
+	uart_tx_refill();
+	if (tx_tail == tx_head)
+		irq_mask(1 << UART_IRQ_TX, 0);
+}
 
-	uart->TDR = x;
+int uart_write_nb(const void *buf, int len)
+{
+	const uint8_t *p = buf;
+	unsigned int ie = irq_save();	/* writers may be ISRs */
+	unsigned int head = tx_head;
+	unsigned int room = UART_TX_RING_SIZE - (head - tx_tail);
+	int n;
+
+	if ((unsigned int)len > room)
+		len = room;
+	for (n = 0; n < len; n++)
+		tx_ring[head++ & (UART_TX_RING_SIZE - 1)] = p[n];
+	tx_head = head;
+
+	uart_tx_refill();	/* start right away if the FIFO has room */
+	if (tx_tail != tx_head)
+		irq_mask(1 << UART_IRQ_TX, 1);
+	irq_restore(ie);
+
+	return len;
+}
+
+void uart_write(const void *buf, int len)
+{
+	const uint8_t *p = buf;
+	int n;
+
+	while (len > 0) {
+		n = uart_write_nb(p, len);
+		p += n;
+		len -= n;
+		if (len) {
+			/* ring full: make progress even with interrupts off */
+			unsigned int ie = irq_save();
+			uart_tx_refill();
+			irq_restore(ie);
+		}
+	}
+}
+
+void uart_write_byte(unsigned char x)
+{
+	uart_write(&x, 1);
 	if(x == '\n')
 		uart_write_byte('\r');
 }
 
+void uart_flush()
+{
+	while (tx_tail != tx_head) {
+		unsigned int ie = irq_save();
+		uart_tx_refill();
+		irq_restore(ie);
+	}
+}
+
+int uart_read_nb(void *buf, int len)
+{
+	uint8_t *p = buf;
+	unsigned int tail = rx_tail;
+	unsigned int ie;
+	int n = 0;
+
+	if (rx_head == tail) {
+		/* nothing queued, the RX interrupt may be masked: poll */
+		ie = irq_save();
+		uart_rx_drain();
+		irq_restore(ie);
+	}
+	while (n < len && tail != rx_head)
+		p[n++] = rx_ring[tail++ & (UART_RX_RING_SIZE - 1)];
+	rx_tail = tail;
+
+	return n;
+}
+
+int uart_read(void *buf, int len)
+{
+	uint8_t *p = buf;
+	int n = 0;
+
+	while (n < len)
+		n += uart_read_nb(p + n, len - n);
+	return n;
+}
+
+/* Number of received bytes waiting to be read */
 int uart_poll()
 {
- 	return uart->SR & UART_SR_RX_RDY;
+	unsigned int ie;
+
+	if (rx_head == rx_tail) {
+		ie = irq_save();
+		uart_rx_drain();
+		irq_restore(ie);
+	}
+	return rx_head - rx_tail;
 }
 
 int uart_read_byte()
 {
- 	return uart ->RDR & 0xff;
-}
\ No newline at end of file
+	uint8_t c;
+
+	return uart_read_nb(&c, 1) ? c : -1;
+}
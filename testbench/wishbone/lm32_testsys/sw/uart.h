@@ -3,7 +3,37 @@
 
 int mprintf(char const *format, ...);
 
+/* LM32 interrupt lines of the UART, see lm32_test_system.vhd */
+#define UART_IRQ_RX 0
+#define UART_IRQ_TX 1
+
+/* Ring buffer sizes, powers of 2 */
+#ifndef UART_TX_RING_SIZE
+#define UART_TX_RING_SIZE 256
+#endif
+#ifndef UART_RX_RING_SIZE
+#define UART_RX_RING_SIZE 64
+#endif
+
+extern volatile unsigned int uart_rx_overflows;
+
+/* Unmasks the UART lines in im; IE is left to the caller (irq_enable()) */
 void uart_init();
+/* Call from _irq_entry() when UART_IRQ_RX or UART_IRQ_TX is pending;
+   clears both bits in ip */
+void uart_irq();
+
+/* Blocking: wait for room in the TX ring / for the data */
 void uart_write_byte(unsigned char x);
+void uart_write(const void *buf, int len);
+int uart_read(void *buf, int len);
+/* Wait until everything written went out to the TX FIFO */
+void uart_flush();
+
+/* Non-blocking: return the number of bytes taken / read */
+int uart_write_nb(const void *buf, int len);
+int uart_read_nb(void *buf, int len);
+int uart_poll();
+int uart_read_byte();
   
 #endif
@@ -39,6 +39,30 @@
 /* definitions for field: RX ready in reg: Status Register */
 #define UART_SR_RX_RDY                        WBGEN2_GEN_MASK(1, 1)
 
+/* definitions for field: RX FIFO supported in reg: Status Register */
+#define UART_SR_RX_FIFO_SUPPORTED             WBGEN2_GEN_MASK(2, 1)
+
+/* definitions for field: TX FIFO supported in reg: Status Register */
+#define UART_SR_TX_FIFO_SUPPORTED             WBGEN2_GEN_MASK(3, 1)
+
+/* definitions for field: RX FIFO data valid in reg: Status Register */
+#define UART_SR_RX_FIFO_VALID                 WBGEN2_GEN_MASK(4, 1)
+
+/* definitions for field: TX FIFO empty in reg: Status Register */
+#define UART_SR_TX_FIFO_EMPTY                 WBGEN2_GEN_MASK(5, 1)
+
+/* definitions for field: TX FIFO full in reg: Status Register */
+#define UART_SR_TX_FIFO_FULL                  WBGEN2_GEN_MASK(6, 1)
+
+/* definitions for field: RX FIFO overflow in reg: Status Register */
+#define UART_SR_RX_FIFO_OVERFLOW              WBGEN2_GEN_MASK(7, 1)
+
+/* definitions for field: RX FIFO data count in reg: Status Register */
+#define UART_SR_RX_FIFO_BYTES_MASK            WBGEN2_GEN_MASK(8, 8)
+#define UART_SR_RX_FIFO_BYTES_SHIFT           8
+#define UART_SR_RX_FIFO_BYTES_W(value)        WBGEN2_GEN_WRITE(value, 8, 8)
+#define UART_SR_RX_FIFO_BYTES_R(reg)          WBGEN2_GEN_READ(reg, 8, 8)
+
 /* definitions for register: Baudrate control register */
 
 /* definitions for register: Transmit data regsiter */
@@ -85,6 +109,14 @@
 #define UART_HOST_RDR_COUNT_W(value)          WBGEN2_GEN_WRITE(value, 9, 16)
 #define UART_HOST_RDR_COUNT_R(reg)            WBGEN2_GEN_READ(reg, 9, 16)
 
+/* definitions for register: UART General Control Register */
+
+/* definitions for field: RX FIFO purge in reg: UART General Control Register */
+#define UART_CR_RX_FIFO_PURGE                 WBGEN2_GEN_MASK(0, 1)
+
+/* definitions for field: TX FIFO purge in reg: UART General Control Register */
+#define UART_CR_TX_FIFO_PURGE                 WBGEN2_GEN_MASK(1, 1)
+
 PACKED struct UART_WB {
   /* [0x0]: REG Status Register */
   uint32_t SR;
@@ -98,6 +130,8 @@ PACKED struct UART_WB {
   uint32_t HOST_TDR;
   /* [0x14]: REG Host VUART Rx register */
   uint32_t HOST_RDR;
+  /* [0x18]: REG UART General Control Register */
+  uint32_t CR;
 };
 
 #endif
@@ -0,0 +1,8 @@
+action = "simulation"
+target = "generic"
+sim_top = "tb_xwb_dma"
+sim_tool = "ghdl"
+
+modules = { "local" :  ["../../../"] };
+
+files = ["tb_wb_latency_slave.vhd", "tb_xwb_dma.vhd"]
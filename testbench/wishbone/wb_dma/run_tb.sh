@@ -0,0 +1,7 @@
+#!/bin/bash
+
+#  Print the throughput table.  Generics can be given, eg: -gg_words=1024
+
+hdlmake makefile && make || exit 1
+
+ghdl -r tb_xwb_dma "$@"
@@ -0,0 +1,105 @@
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+use ieee.math_real.all;
+use work.wishbone_pkg.all;
+
+--  Pipelined WB slave for throughput measurements.  A request is acked
+--  latency_i cycles after it is accepted (1: in the next cycle), plus
+--  penalty_i cycles when its address is neither the previous one nor the
+--  next word (like a row change in an SDRAM).  Acks are in order, at most
+--  one per cycle.  stall_pct_i percent of the cycles are stalled at random.
+--  Reads return their address, writes are dropped.
+entity tb_wb_latency_slave is
+  generic (
+    g_seed : positive := 1);
+  port (
+    clk_i       : in  std_logic;
+    rst_n_i     : in  std_logic;
+    latency_i   : in  natural;
+    penalty_i   : in  natural;
+    stall_pct_i : in  natural;
+    wb_i        : in  t_wishbone_slave_in;
+    wb_o        : out t_wishbone_slave_out);
+end tb_wb_latency_slave;
+
+architecture sim of tb_wb_latency_slave is
+begin
+  process (clk_i)
+    --  Requests accepted and not yet acked: the cycle of their ack and
+    --  their address.  Deep enough for any ring of xwb_dma.
+    constant c_depth : natural := 256;
+    type t_due is array (0 to c_depth - 1) of natural;
+    type t_adr is array (0 to c_depth - 1) of t_wishbone_address;
+    variable due      : t_due;
+    variable adr      : t_adr;
+    variable rd, wr   : natural range 0 to c_depth - 1;
+    variable count    : natural range 0 to c_depth;
+    variable cycle    : natural;
+    variable last_due : natural;
+    variable last_adr : t_wishbone_address;
+    variable t        : natural;
+    variable ack      : std_logic;
+    variable stall    : std_logic;
+    variable seed1    : positive := g_seed;
+    variable seed2    : positive := 16#5eed#;
+    variable x        : real;
+  begin
+    if rising_edge (clk_i) then
+      if rst_n_i = '0' then
+        rd := 0;
+        wr := 0;
+        count := 0;
+        cycle := 0;
+        last_due := 0;
+        last_adr := (others => '0');
+        ack := '0';
+        stall := '0';
+        wb_o <= (ack => '0',
+                 err => '0',
+                 rty => '0',
+                 stall => '0',
+                 dat => (others => '0'));
+      else
+        --  The ack of this cycle was taken.
+        if ack = '1' then
+          rd := (rd + 1) mod c_depth;
+          count := count - 1;
+        end if;
+
+        if (wb_i.cyc and wb_i.stb and not stall) = '1' then
+          t := cycle + latency_i;
+          if wb_i.adr /= last_adr
+            and unsigned(wb_i.adr) /= unsigned(last_adr) + 4
+          then
+            t := t + penalty_i;
+          end if;
+          if t <= last_due then
+            t := last_due + 1;
+          end if;
+          due(wr) := t;
+          adr(wr) := wb_i.adr;
+          wr := (wr + 1) mod c_depth;
+          count := count + 1;
+          last_due := t;
+          last_adr := wb_i.adr;
+        end if;
+
+        --  Outputs for the next cycle.
+        cycle := cycle + 1;
+        ack := '0';
+        if count /= 0 and due(rd) <= cycle then
+          ack := '1';
+        end if;
+        uniform (seed1, seed2, x);
+        stall := '0';
+        if x * 100.0 < real(stall_pct_i) or count >= c_depth - 2 then
+          stall := '1';
+        end if;
+        wb_o.ack <= ack;
+        wb_o.stall <= stall;
+        wb_o.dat <= adr(rd);
+      end if;
+    end if;
+  end process;
+end sim;
@@ -0,0 +1,320 @@
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+use std.textio.all;
+use work.wishbone_pkg.all;
+
+--  Throughput of xwb_dma and xwb_streamer, in words per cycle, for each
+--  logRingLen against slaves with a given latency and rate of stalls.
+--  Both the read and the write slave have the same parameters, so the
+--  combined latency of the comments in xwb_dma.vhd is twice the latency.
+--
+--  xwb_dma is measured in register mode from the write of the count to the
+--  interrupt, for a read and write stride of 0 (a FIFO), 4 (sequential)
+--  and 64 (every access pays g_penalty more cycles).  xwb_streamer always
+--  has a stride of 0, it is measured over g_window cycles.  The table is
+--  printed on the standard output, see run_tb.sh.
+entity tb_xwb_dma is
+  generic (
+    --  Words per xwb_dma transfer.
+    g_words   : positive := 512;
+    --  Cycles over which xwb_streamer is measured.
+    g_window  : positive := 2048;
+    --  Extra latency of a non-sequential access.
+    g_penalty : natural := 4);
+end tb_xwb_dma;
+
+architecture arch of tb_xwb_dma is
+  constant c_clk_period : time := 8 ns;
+
+  type t_nat_array is array (natural range <>) of natural;
+
+  constant c_rings     : t_nat_array := (1, 2, 3, 4, 5, 6);
+  constant c_latencies : t_nat_array := (1, 2, 4, 8, 16);
+  constant c_stalls    : t_nat_array := (0, 25);
+  constant c_strides   : t_nat_array := (0, 4, 64);
+
+  --  Base addresses of the xwb_dma transfers.
+  constant c_rbase : natural := 16#0001_0000#;
+  constant c_wbase : natural := 16#0080_0000#;
+
+  type t_count_array is array (c_rings'range) of natural;
+
+  signal rst_n     : std_logic;
+  signal clk       : std_logic;
+  signal cycle     : natural := 0;
+
+  --  Slave parameters, for all the slaves.
+  signal latency   : natural := 1;
+  signal stall_pct : natural := 0;
+
+  signal dma_in    : t_wishbone_slave_in_array(c_rings'range);
+  signal dma_out   : t_wishbone_slave_out_array(c_rings'range);
+  signal irq       : std_logic_vector(c_rings'range);
+
+  --  Stride of the xwb_dma transfer, and reset of its checker.
+  signal stride    : natural := 0;
+  signal clear     : std_logic_vector(c_rings'range);
+
+  --  Writes of the xwb_dma transfer, and of the streamers since reset.
+  signal wcount    : t_count_array;
+  signal scount    : t_count_array;
+
+  --  For end of test.
+  signal done : boolean := False;
+
+  --  Words per cycle, with 3 decimals.
+  function rate (words, cycles : natural) return string is
+    variable v    : natural;
+    variable frac : string (1 to 4);
+  begin
+    v := (words * 1000 + cycles / 2) / cycles;
+    frac := integer'image(1000 + v mod 1000);
+    return integer'image(v / 1000) & "." & frac(2 to 4);
+  end rate;
+
+  function lpad (s : string; w : natural) return string is
+    constant c_sp : string (1 to w) := (others => ' ');
+  begin
+    if s'length >= w then
+      return s;
+    end if;
+    return c_sp(1 to w - s'length) & s;
+  end lpad;
+begin
+  --  Clock.
+  process
+  begin
+    clk <= '0';
+    wait for c_clk_period / 2;
+    clk <= '1';
+    wait for c_clk_period / 2;
+    if done then
+      report "end of test";
+      wait;
+    end if;
+  end process;
+
+  rst_n <= '0', '1' after 8 ns;
+
+  process (clk)
+  begin
+    if rising_edge (clk) then
+      cycle <= cycle + 1;
+    end if;
+  end process;
+
+  --  Test process.
+  process
+    variable l      : line;
+    variable cycles : natural;
+    variable words  : natural;
+
+    procedure print (s : string) is
+    begin
+      write (l, s);
+      writeline (output, l);
+    end print;
+
+    --  xwb_dma acks in the next cycle without stalling.
+    procedure write_reg (i, adr, dat : natural) is
+    begin
+      dma_in(i) <= (cyc => '1',
+                    stb => '1',
+                    adr => std_logic_vector(to_unsigned(adr, 32)),
+                    sel => "1111",
+                    we  => '1',
+                    dat => std_logic_vector(to_unsigned(dat, 32)));
+      wait until rising_edge (clk);
+      dma_in(i) <= cc_dummy_slave_in;
+    end write_reg;
+
+    procedure run_dma (i, s : natural; cycles : out natural) is
+      variable t0 : natural;
+    begin
+      clear(i) <= '1';
+      stride <= s;
+      write_reg (i, 16#00#, c_rbase);
+      write_reg (i, 16#04#, c_wbase);
+      write_reg (i, 16#08#, s);
+      write_reg (i, 16#0c#, s);
+      clear(i) <= '0';
+      t0 := cycle;
+      write_reg (i, 16#10#, g_words);
+      loop
+        wait until rising_edge (clk);
+        exit when irq(i) = '1';
+        assert cycle - t0 < 256 * g_words
+          report "xwb_dma transfer timeout" severity failure;
+      end loop;
+      cycles := cycle - t0;
+      assert wcount(i) = g_words
+        report "xwb_dma wrote " & natural'image(wcount(i)) & " words"
+        severity error;
+    end run_dma;
+
+    procedure run_streamer (i : natural; words : out natural) is
+      variable n0 : natural;
+    begin
+      for c in 1 to 64 loop
+        wait until rising_edge (clk);
+      end loop;
+      n0 := scount(i);
+      for c in 1 to g_window loop
+        wait until rising_edge (clk);
+      end loop;
+      words := scount(i) - n0;
+    end run_streamer;
+  begin
+    dma_in <= (others => cc_dummy_slave_in);
+    clear <= (others => '1');
+
+    wait until rst_n = '1';
+    wait until rising_edge (clk);
+
+    print ("Words per cycle, " & natural'image(g_words)
+           & " words per xwb_dma transfer.");
+    print ("latency: cycles from request to ack in each slave, "
+           & "stall: % of cycles stalled by the slaves,");
+    print ("s=N: xwb_dma with a stride of N, a non-sequential access costs "
+           & natural'image(g_penalty) & " more cycles.");
+    for i in c_rings'range loop
+      print ("");
+      print ("logRingLen " & natural'image(c_rings(i))
+             & " (xwb_dma.vhd: streams up to a combined latency of "
+             & integer'image(2**c_rings(i) - 2) & ")");
+      print (" latency stall%    s=0    s=4   s=64 streamer");
+      for li in c_latencies'range loop
+        for si in c_stalls'range loop
+          latency <= c_latencies(li);
+          stall_pct <= c_stalls(si);
+          wait until rising_edge (clk);
+          write (l, lpad(natural'image(c_latencies(li)), 8));
+          write (l, lpad(natural'image(c_stalls(si)), 7));
+          for k in c_strides'range loop
+            run_dma (i, c_strides(k), cycles);
+            write (l, lpad(rate(g_words, cycles), 7));
+          end loop;
+          run_streamer (i, words);
+          write (l, lpad(rate(words, g_window), 9));
+          writeline (output, l);
+        end loop;
+      end loop;
+    end loop;
+
+    done <= true;
+    wait;
+  end process;
+
+  gen_rings: for i in c_rings'range generate
+    signal r_in, w_in   : t_wishbone_master_in;
+    signal r_out, w_out : t_wishbone_master_out;
+    signal sr_in, sw_in   : t_wishbone_master_in;
+    signal sr_out, sw_out : t_wishbone_master_out;
+  begin
+    inst_xwb_dma: entity work.xwb_dma
+      generic map (
+        logRingLen => c_rings(i))
+      port map (
+        clk_i       => clk,
+        rst_n_i     => rst_n,
+        slave_i     => dma_in(i),
+        slave_o     => dma_out(i),
+        r_master_i  => r_in,
+        r_master_o  => r_out,
+        w_master_i  => w_in,
+        w_master_o  => w_out,
+        interrupt_o => irq(i));
+
+    inst_dma_rd: entity work.tb_wb_latency_slave
+      generic map (
+        g_seed => 4 * i + 1)
+      port map (
+        clk_i       => clk,
+        rst_n_i     => rst_n,
+        latency_i   => latency,
+        penalty_i   => g_penalty,
+        stall_pct_i => stall_pct,
+        wb_i        => r_out,
+        wb_o        => r_in);
+
+    inst_dma_wr: entity work.tb_wb_latency_slave
+      generic map (
+        g_seed => 4 * i + 2)
+      port map (
+        clk_i       => clk,
+        rst_n_i     => rst_n,
+        latency_i   => latency,
+        penalty_i   => g_penalty,
+        stall_pct_i => stall_pct,
+        wb_i        => w_out,
+        wb_o        => w_in);
+
+    --  Check the xwb_dma writes: the k-th one copies the k-th read, whose
+    --  data is its address.
+    process (clk)
+      variable k : natural;
+    begin
+      if rising_edge (clk) then
+        if clear(i) = '1' then
+          k := 0;
+        elsif (w_out.cyc and w_out.stb and not w_in.stall) = '1' then
+          assert unsigned(w_out.adr) = to_unsigned(c_wbase + k * stride, 32)
+            and unsigned(w_out.dat) = to_unsigned(c_rbase + k * stride, 32)
+            report "bad xwb_dma write " & natural'image(k)
+            & " with logRingLen " & natural'image(c_rings(i))
+            severity error;
+          k := k + 1;
+        end if;
+        wcount(i) <= k;
+      end if;
+    end process;
+
+    inst_xwb_streamer: entity work.xwb_streamer
+      generic map (
+        logRingLen => c_rings(i))
+      port map (
+        clk_i      => clk,
+        rst_n_i    => rst_n,
+        r_master_i => sr_in,
+        r_master_o => sr_out,
+        w_master_i => sw_in,
+        w_master_o => sw_out);
+
+    inst_streamer_rd: entity work.tb_wb_latency_slave
+      generic map (
+        g_seed => 4 * i + 3)
+      port map (
+        clk_i       => clk,
+        rst_n_i     => rst_n,
+        latency_i   => latency,
+        penalty_i   => g_penalty,
+        stall_pct_i => stall_pct,
+        wb_i        => sr_out,
+        wb_o        => sr_in);
+
+    inst_streamer_wr: entity work.tb_wb_latency_slave
+      generic map (
+        g_seed => 4 * i + 4)
+      port map (
+        clk_i       => clk,
+        rst_n_i     => rst_n,
+        latency_i   => latency,
+        penalty_i   => g_penalty,
+        stall_pct_i => stall_pct,
+        wb_i        => sw_out,
+        wb_o        => sw_in);
+
+    --  Count the streamer writes.
+    process (clk)
+      variable n : natural := 0;
+    begin
+      if rising_edge (clk) then
+        if (sw_out.cyc and sw_out.stb and not sw_in.stall) = '1' then
+          n := n + 1;
+        end if;
+        scount(i) <= n;
+      end if;
+    end process;
+  end generate gen_rings;
+end arch;
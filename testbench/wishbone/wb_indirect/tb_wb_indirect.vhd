@@ -8,6 +8,20 @@ entity tb_wb_indirect is
 end tb_wb_indirect;
 
 architecture arch of tb_wb_indirect is
+  constant c_clk_period : time := 8 ns;
+
+  --  Cycles the slave takes to ack, to model a crossbar and a memory.
+  constant c_latency : natural := 2;
+
+  --  Words per block in the throughput measurements.
+  constant c_block : natural := 256;
+
+  --  Slave registers.
+  constant c_addr   : natural := 16#00#;
+  constant c_data   : natural := 16#04#;
+  constant c_ctrl   : natural := 16#08#;
+  constant c_window : natural := 16#40#;
+
   signal rst_n         : std_logic;
   signal clk           : std_logic;
   signal wb_in         : t_wishbone_slave_in;
@@ -24,9 +38,9 @@ begin
   process
   begin
     clk <= '0';
-    wait for 4 ns;
+    wait for c_clk_period / 2;
     clk <= '1';
-    wait for 4 ns;
+    wait for c_clk_period / 2;
     if done then
       report "end of test";
       wait;
@@ -38,6 +52,53 @@ begin
   --  Test process.
   process
     variable data : std_logic_vector (31 downto 0);
+    variable t0   : time;
+
+    procedure report_rate (what : string; t : time) is
+      constant c_ns : real := real(t / 1 ns);
+    begin
+      report what & ": " & real'image(real(c_block) * 1.0e9 / c_ns)
+        & " words/s, " & real'image(c_ns / real(c_block * (c_clk_period / 1 ns)))
+        & " cycles/word";
+    end report_rate;
+
+    --  Write (or read and check) c_block words from 0x1000 on.  Words are
+    --  x"5a00_0000" + index.
+    procedure write_block (naive, win : boolean) is
+    begin
+      if not naive then
+        write32_pl (clk, wb_in, wb_out, c_addr, x"0000_1000");
+      end if;
+      for i in 0 to c_block - 1 loop
+        if naive then
+          write32_pl (clk, wb_in, wb_out, c_addr, std_logic_vector(to_unsigned(16#1000# + 4 * i, 32)));
+          write32_pl (clk, wb_in, wb_out, c_data, std_logic_vector(to_unsigned(16#5a00_0000# + i, 32)));
+        elsif win then
+          write32_pl (clk, wb_in, wb_out, c_window + 4 * (i mod 16), std_logic_vector(to_unsigned(16#5a00_0000# + i, 32)));
+        else
+          write32_pl (clk, wb_in, wb_out, c_data, std_logic_vector(to_unsigned(16#5a00_0000# + i, 32)));
+        end if;
+      end loop;
+    end write_block;
+
+    procedure read_block (naive, win : boolean) is
+    begin
+      if not naive then
+        write32_pl (clk, wb_in, wb_out, c_addr, x"0000_1000");
+      end if;
+      for i in 0 to c_block - 1 loop
+        if naive then
+          write32_pl (clk, wb_in, wb_out, c_addr, std_logic_vector(to_unsigned(16#1000# + 4 * i, 32)));
+          read32_pl (clk, wb_in, wb_out, c_data, data);
+        elsif win then
+          read32_pl (clk, wb_in, wb_out, c_window + 4 * (i mod 16), data);
+        else
+          read32_pl (clk, wb_in, wb_out, c_data, data);
+        end if;
+        assert data = std_logic_vector(to_unsigned(16#5a00_0000# + i, 32))
+          report "bad block data at word " & natural'image(i) severity error;
+      end loop;
+    end read_block;
   begin
     wb_in.cyc <= '0';
     wb_in.stb <= '0';
@@ -56,7 +117,11 @@ begin
 
     wait until rising_edge (clk);
 
+    --  Writes are posted: the slave ack comes before the master one.
     write32_pl (clk, wb_in, wb_out, x"0000_0004", x"1234_5678");
+    for i in 1 to c_latency + 2 loop
+      wait until rising_edge (clk);
+    end loop;
     assert last_addr = x"0000_2304";
     assert last_data = x"1234_5678";
 
@@ -64,6 +129,55 @@ begin
     assert data = x"0000_2308";
     assert last_data = x"1234_5678";
 
+    --  Without autoinc, the address stays.
+    write32_pl (clk, wb_in, wb_out, c_ctrl, x"0000_0000");
+    write32_pl (clk, wb_in, wb_out, c_addr, x"0000_3000");
+    write32_pl (clk, wb_in, wb_out, c_data, x"0000_0001");
+    write32_pl (clk, wb_in, wb_out, c_data, x"0000_0002");
+    read32_pl (clk, wb_in, wb_out, c_addr, data);
+    assert data = x"0000_3000" report "addr incremented without autoinc";
+    read32_pl (clk, wb_in, wb_out, c_data, data);
+    assert data = x"0000_0002";
+    write32_pl (clk, wb_in, wb_out, c_ctrl, x"0000_0001");
+
+    --  Throughput, against a write to addr before each data access.
+    t0 := now;
+    write_block (true, false);
+    report_rate ("addr+data write", now - t0);
+    t0 := now;
+    read_block (true, false);
+    report_rate ("addr+data read", now - t0);
+
+    t0 := now;
+    write_block (false, false);
+    report_rate ("autoinc write", now - t0);
+    t0 := now;
+    read_block (false, false);
+    report_rate ("autoinc read", now - t0);
+
+    t0 := now;
+    write_block (false, true);
+    report_rate ("window write", now - t0);
+    t0 := now;
+    read_block (false, true);
+    report_rate ("window read", now - t0);
+
+    write32_pl (clk, wb_in, wb_out, c_ctrl, x"0000_0003");
+    t0 := now;
+    read_block (false, false);
+    report_rate ("prefetch read", now - t0);
+    t0 := now;
+    read_block (false, true);
+    report_rate ("prefetch window read", now - t0);
+
+    --  A write drops the prefetched word.
+    write32_pl (clk, wb_in, wb_out, c_addr, x"0000_1000");
+    read32_pl (clk, wb_in, wb_out, c_data, data);
+    write32_pl (clk, wb_in, wb_out, c_data, x"0000_0055");
+    write32_pl (clk, wb_in, wb_out, c_addr, x"0000_1004");
+    read32_pl (clk, wb_in, wb_out, c_data, data);
+    assert data = x"0000_0055" report "stale prefetched data";
+
     done <= true;
     wait;
   end process;
@@ -77,8 +191,18 @@ begin
       master_wb_i => master_wb_in,
       master_wb_o => master_wb_out);
 
-  --  WB slave.
+  --  WB slave: a memory, unwritten words read as their address.  Acks
+  --  after c_latency cycles and stalls meanwhile.
   process (clk)
+    type t_mem is array (0 to 4095) of std_logic_vector(31 downto 0);
+    variable mem   : t_mem;
+    variable valid : std_logic_vector(0 to 4095) := (others => '0');
+    variable busy  : boolean := false;
+    variable count : natural;
+    variable adr   : std_logic_vector(31 downto 0);
+    variable dat   : std_logic_vector(31 downto 0);
+    variable we    : std_logic;
+    variable idx   : natural;
   begin
     if rising_edge (clk) then
       if rst_n = '0' then
@@ -87,17 +211,39 @@ begin
                          ack => '0',
                          stall => '0',
                          dat => (others => 'U'));
+        busy := false;
       else
         master_wb_in.ack <= '0';
-        master_wb_in.stall <= '0';
-        if (master_wb_out.cyc and master_wb_out.stb) = '1' then
+        if busy then
+          if count <= 1 then
+            busy := false;
+            idx := to_integer(unsigned(adr(13 downto 2)));
+            if we = '1' then
+              mem(idx) := dat;
+              valid(idx) := '1';
+            elsif valid(idx) = '1' then
+              master_wb_in.dat <= mem(idx);
+            else
+              master_wb_in.dat <= adr;
+            end if;
+            master_wb_in.ack <= '1';
+            master_wb_in.stall <= '0';
+          else
+            count := count - 1;
+          end if;
+        elsif (master_wb_out.cyc and master_wb_out.stb) = '1'
+          and master_wb_in.ack = '0'
+        then
           --  Start of transaction.
           last_addr <= master_wb_out.adr;
           if master_wb_out.we = '1' then
             last_data <= master_wb_out.dat;
           end if;
-          master_wb_in.dat <= master_wb_out.adr;
-          master_wb_in.ack <= '1';
+          adr := master_wb_out.adr;
+          we := master_wb_out.we;
+          dat := master_wb_out.dat;
+          busy := true;
+          count := c_latency;
           master_wb_in.stall <= '1';
         end if;
       end if;
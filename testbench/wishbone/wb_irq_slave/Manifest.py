@@ -0,0 +1,8 @@
+action = "simulation"
+target = "generic"
+sim_top = "tb_wb_irq_slave"
+sim_tool = ""
+
+modules = { "local" :  ["../../../", "../../../sim/vhdl"] };
+
+files = ["tb_wb_irq_slave.vhd"]
@@ -0,0 +1,156 @@
+--  Testbench for wb_irq_slave: dequeue MSIs with the POP register, with
+--  g_auto_pop and with g_packed, and report the bus cycles per message.
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+use work.wishbone_pkg.all;
+use work.sim_wishbone.all;
+
+entity tb_wb_irq_slave is
+end tb_wb_irq_slave;
+
+architecture arch of tb_wb_irq_slave is
+  --  0: POP register, 1: g_auto_pop, 2: g_auto_pop and g_packed.
+  constant c_NMODES : natural := 3;
+  constant c_NMSGS  : natural := 6;
+
+  constant c_STATUS   : natural := 16#04#;
+  constant c_POP      : natural := 16#08#;
+  constant c_QUEUE0   : natural := 16#20#;
+  constant c_OFFS_DATA: natural := 16#00#;
+  constant c_OFFS_ADDR: natural := 16#04#;
+  constant c_OFFS_SEL : natural := 16#08#;
+  constant c_OFFS_POP : natural := 16#0C#;
+
+  signal rst_n    : std_logic;
+  signal clk      : std_logic;
+  signal cycles   : natural := 0;
+  signal msi_in   : t_wishbone_slave_in_array(c_NMODES-1 downto 0);
+  signal msi_out  : t_wishbone_slave_out_array(c_NMODES-1 downto 0);
+  signal ctrl_in  : t_wishbone_slave_in_array(c_NMODES-1 downto 0);
+  signal ctrl_out : t_wishbone_slave_out_array(c_NMODES-1 downto 0);
+
+  function msg_dat (n : natural) return std_logic_vector is
+  begin
+    return x"CAFE_00" & std_logic_vector(to_unsigned(n, 8));
+  end msg_dat;
+
+  function msg_adr (n : natural) return std_logic_vector is
+  begin
+    return std_logic_vector(to_unsigned(16#100# + 4 * n, 32));
+  end msg_adr;
+
+  --  For end of test.
+  signal done : boolean := False;
+begin
+  --  Clock.
+  process
+  begin
+    clk <= '0';
+    wait for 4 ns;
+    clk <= '1';
+    wait for 4 ns;
+    if done then
+      report "end of test";
+      wait;
+    end if;
+  end process;
+
+  process (clk)
+  begin
+    if rising_edge (clk) then
+      cycles <= cycles + 1;
+    end if;
+  end process;
+
+  rst_n <= '0', '1' after 8 ns;
+
+  --  Test process.
+  process
+    procedure dequeue (signal wb_o : out t_wishbone_master_out;
+                       signal wb_i : in  t_wishbone_master_in;
+                       mode        : natural) is
+      variable stat, dat, adr, sel : std_logic_vector (31 downto 0);
+      variable n  : natural := 0;
+      variable t0 : natural;
+    begin
+      t0 := cycles;
+      loop
+        read32_pl (clk, wb_o, wb_i, c_STATUS, stat);
+        exit when stat(0) = '0';
+
+        read32_pl (clk, wb_o, wb_i, c_QUEUE0 + c_OFFS_DATA, dat);
+        case mode is
+          when 0 =>
+            read32_pl (clk, wb_o, wb_i, c_QUEUE0 + c_OFFS_ADDR, adr);
+            read32_pl (clk, wb_o, wb_i, c_QUEUE0 + c_OFFS_SEL, sel);
+            write32_pl (clk, wb_o, wb_i, c_POP, x"0000_0001");
+          when 1 =>
+            read32_pl (clk, wb_o, wb_i, c_QUEUE0 + c_OFFS_ADDR, adr);
+            read32_pl (clk, wb_o, wb_i, c_QUEUE0 + c_OFFS_POP, sel);
+          when others =>
+            read32_pl (clk, wb_o, wb_i, c_QUEUE0 + c_OFFS_POP, sel);
+            adr := x"0" & sel(27 downto 0);
+            sel := x"0000_000" & sel(31 downto 28);
+        end case;
+
+        assert n < c_NMSGS
+          report "mode " & natural'image(mode) & ": too many messages"
+          severity failure;
+        assert dat = msg_dat(n) and adr = msg_adr(n) and sel = x"0000_000F"
+          report "mode " & natural'image(mode) & ": bad message "
+          & natural'image(n) severity error;
+        n := n + 1;
+      end loop;
+
+      assert n = c_NMSGS
+        report "mode " & natural'image(mode) & ": missing messages"
+        severity error;
+      report "mode " & natural'image(mode) & ": "
+        & natural'image((cycles - t0) / c_NMSGS) & " cycles per message";
+    end dequeue;
+  begin
+    init (msi_in(0));
+    init (msi_in(1));
+    init (msi_in(2));
+    init (ctrl_in(0));
+    init (ctrl_in(1));
+    init (ctrl_in(2));
+
+    wait until rst_n = '1';
+    wait until rising_edge (clk);
+
+    --  Queue the messages.
+    for n in 0 to c_NMSGS - 1 loop
+      write32_pl (clk, msi_in(0), msi_out(0), msg_adr(n), msg_dat(n));
+      write32_pl (clk, msi_in(1), msi_out(1), msg_adr(n), msg_dat(n));
+      write32_pl (clk, msi_in(2), msi_out(2), msg_adr(n), msg_dat(n));
+    end loop;
+
+    wait until rising_edge (clk);
+
+    dequeue (ctrl_in(0), ctrl_out(0), 0);
+    dequeue (ctrl_in(1), ctrl_out(1), 1);
+    dequeue (ctrl_in(2), ctrl_out(2), 2);
+
+    done <= true;
+    wait;
+  end process;
+
+  gen_dut: for i in 0 to c_NMODES - 1 generate
+    inst_wb_irq_slave: entity work.wb_irq_slave
+      generic map (
+        g_queues   => 1,
+        g_depth    => 8,
+        g_auto_pop => i /= 0,
+        g_packed   => i = 2)
+      port map (
+        clk_i        => clk,
+        rst_n_i      => rst_n,
+        irq_slave_o  => msi_out(i downto i),
+        irq_slave_i  => msi_in(i downto i),
+        irq_o        => open,
+        ctrl_slave_o => ctrl_out(i),
+        ctrl_slave_i => ctrl_in(i));
+  end generate;
+end arch;
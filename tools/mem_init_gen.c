@@ -0,0 +1,481 @@
+/*------------------------------------------------------------------------------
+ * CERN BE-CO-HT
+ * General Cores
+ * https://www.ohwr.org/projects/general-cores
+ *------------------------------------------------------------------------------
+ *
+ * Generate an init file for block rams from a raw binary image, such as the
+ * one generated by GNU binutils "objcopy -O binary". Replaces mem_init_gen.py
+ * and the LM32 test system genraminit.c; the command line of mem_init_gen.py
+ * (including -of) is still accepted.
+ *
+ * The input is streamed in large blocks and every output line is built from
+ * lookup tables in a large output buffer, so the run time is bound by the
+ * I/O for multi-MB images.
+ *
+ * Usage:
+ *   mem_init_gen [-f format] [-w width] [-d depth] [-p pad] [-i]
+ *                [-n name] [-o output] input_file
+ *
+ * Output formats:
+ *
+ *   bram : custom ascii-encoded binary, one word per line, for Xilinx, to be
+ *          used with the functions in the memory_loader_pkg (default)
+ *
+ *   mif  : Altera Memory Initialization File
+ *
+ *   vhd  : constant VHDL array of type t_meminit_array, as defined in
+ *          genram_pkg
+ *
+ *   write: "write <addr> <data>" lines, as read by the testbenches (what
+ *          genraminit used to produce)
+ *
+ *   bin  : raw binary, <width> bytes per word, after padding, trimming and
+ *          byte swapping, for simulators that load binary images
+ *
+ * A word is <width> bytes of the input, the first one being the most
+ * significant unless -i is given. The last word is padded with <pad>, and
+ * so are the words up to <depth> if the input is shorter; a longer input is
+ * trimmed to <depth>. mif and vhd need the word count up front, so without
+ * -d their input must be a regular file.
+ *
+ *------------------------------------------------------------------------------
+ * Copyright CERN 2018
+ *------------------------------------------------------------------------------
+ * This Source Code Form is subject to the terms of the Mozilla Public License,
+ * version 2.0. If a copy of the MPL was not distributed with this file, You can
+ * obtain one at https://mozilla.org/MPL/2.0/.
+ *------------------------------------------------------------------------------
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#define IN_BLOCK (1 << 20)
+#define OUT_BLOCK (1 << 20)
+#define MAX_WIDTH 64
+
+enum format { F_BRAM, F_MIF, F_VHD, F_WRITE, F_BIN };
+
+static const char *format_names[] = { "bram", "mif", "vhd", "write", "bin" };
+
+static char bin_lut[256][8];
+static char hex_lut[256][2];
+static char hexu_lut[256][2];
+
+static FILE *out;
+static char out_buf[OUT_BLOCK];
+static size_t out_len;
+
+static void flush_out(void)
+{
+	if (out_len && fwrite(out_buf, 1, out_len, out) != out_len) {
+		perror("write");
+		exit(1);
+	}
+	out_len = 0;
+}
+
+/* Room for n more bytes in out_buf */
+static inline char *reserve(size_t n)
+{
+	if (out_len + n > sizeof(out_buf))
+		flush_out();
+	return out_buf + out_len;
+}
+
+static void put_str(const char *s)
+{
+	size_t n = strlen(s);
+
+	memcpy(reserve(n), s, n);
+	out_len += n;
+}
+
+static void init_luts(void)
+{
+	static const char hex[] = "0123456789abcdef";
+	static const char hexu[] = "0123456789ABCDEF";
+	int i, b;
+
+	for (i = 0; i < 256; i++) {
+		for (b = 0; b < 8; b++)
+			bin_lut[i][b] = (i >> (7 - b)) & 1 ? '1' : '0';
+		hex_lut[i][0] = hex[i >> 4];
+		hex_lut[i][1] = hex[i & 15];
+		hexu_lut[i][0] = hexu[i >> 4];
+		hexu_lut[i][1] = hexu[i & 15];
+	}
+}
+
+/* Lower-case hex of n without leading zeroes, returns the length */
+static int put_addr(char *p, unsigned long long n)
+{
+	char tmp[16];
+	int len = 0, i;
+
+	do {
+		tmp[len++] = "0123456789abcdef"[n & 15];
+		n >>= 4;
+	} while (n);
+	for (i = 0; i < len; i++)
+		p[i] = tmp[len - 1 - i];
+	return len;
+}
+
+/* Decimal n right-aligned in a field of w characters */
+static void put_index(char *p, unsigned long long n, int w)
+{
+	do {
+		p[--w] = '0' + n % 10;
+		n /= 10;
+	} while (n && w);
+	while (w)
+		p[--w] = ' ';
+}
+
+struct gen {
+	enum format format;
+	int width;
+	unsigned long long words;	/* total, after padding/trimming */
+	unsigned long long addr;	/* next word */
+	int vhd_cols, vhd_iwidth;
+};
+
+/* One output word; w[0] is the most significant byte */
+static void put_word(struct gen *g, const uint8_t *w)
+{
+	char *p;
+	int i;
+
+	switch (g->format) {
+	case F_BRAM:
+		p = reserve(g->width * 8 + 1);
+		for (i = 0; i < g->width; i++, p += 8)
+			memcpy(p, bin_lut[w[i]], 8);
+		*p = '\n';
+		out_len += g->width * 8 + 1;
+		break;
+	case F_MIF:
+		p = reserve(16 + 3 + g->width * 2 + 2);
+		p += put_addr(p, g->addr);
+		memcpy(p, " : ", 3);
+		p += 3;
+		for (i = 0; i < g->width; i++, p += 2)
+			memcpy(p, hex_lut[w[i]], 2);
+		memcpy(p, ";\n", 2);
+		p += 2;
+		out_len = p - out_buf;
+		break;
+	case F_WRITE:
+		p = reserve(6 + 16 + 1 + g->width * 2 + 1);
+		memcpy(p, "write ", 6);
+		p += 6;
+		p += put_addr(p, g->addr);
+		*p++ = ' ';
+		for (i = 0; i < g->width; i++, p += 2)
+			memcpy(p, hexu_lut[w[i]], 2);
+		*p++ = '\n';
+		out_len = p - out_buf;
+		break;
+	case F_VHD:
+		p = reserve(64 + g->width * 2);
+		memcpy(p, "    ", 4);
+		put_index(p + 4, g->addr, g->vhd_iwidth);
+		p += 4 + g->vhd_iwidth;
+		memcpy(p, " => x\"", 6);
+		p += 6;
+		for (i = 0; i < g->width; i++, p += 2)
+			memcpy(p, hex_lut[w[i]], 2);
+		*p++ = '"';
+		if (g->addr == g->words - 1) {
+			memcpy(p, ");\n", 3);
+			p += 3;
+		} else {
+			*p++ = ',';
+			if (g->addr % g->vhd_cols == g->vhd_cols - 1)
+				*p++ = '\n';
+		}
+		out_len = p - out_buf;
+		break;
+	case F_BIN:
+		memcpy(reserve(g->width), w, g->width);
+		out_len += g->width;
+		break;
+	}
+	g->addr++;
+}
+
+static void put_header(struct gen *g, const char *in_name, const char *name,
+		       int argc, char *argv[])
+{
+	char line[256], date[64];
+	time_t now;
+	int i;
+
+	switch (g->format) {
+	case F_MIF:
+		snprintf(line, sizeof(line),
+			 "DEPTH = %llu;\nWIDTH = %d;\nADDRESS_RADIX = HEX;\n"
+			 "DATA_RADIX = HEX;\nCONTENT\nBEGIN\n",
+			 g->words, g->width * 8);
+		put_str(line);
+		break;
+	case F_VHD:
+		now = time(NULL);
+		strftime(date, sizeof(date), "%A, %B %d %Y", localtime(&now));
+		for (i = 0; i < 80; i++)
+			put_str("-");
+		snprintf(line, sizeof(line),
+			 "\n-- Memory initialization file for %s\n--\n"
+			 "-- This file was automatically generated on %s\n"
+			 "-- by mem_init_gen using the following arguments:\n--  ",
+			 in_name, date);
+		put_str(line);
+		for (i = 1; i < argc; i++) {
+			put_str(" ");
+			put_str(argv[i]);
+		}
+		put_str("\n--\n-- mem_init_gen is part of OHWR general-cores:\n"
+			"-- https://www.ohwr.org/projects/general-cores/wiki\n");
+		for (i = 0; i < 80; i++)
+			put_str("-");
+		put_str("\n\nlibrary ieee;\nuse ieee.std_logic_1164.all;\n"
+			"use ieee.numeric_std.all;\n\nlibrary work;\n"
+			"use work.memory_loader_pkg.all;\n\n");
+		snprintf(line, sizeof(line),
+			 "package %s_pkg is\n\n"
+			 "  constant %s : t_meminit_array(%llu downto 0, %d downto 0) := (\n",
+			 name, name, g->words - 1, g->width * 8 - 1);
+		put_str(line);
+		snprintf(line, sizeof(line), "%llu", g->words);
+		g->vhd_iwidth = strlen(line);
+		g->vhd_cols = 80 / (12 + g->vhd_iwidth + g->width * 2);
+		if (g->vhd_cols < 1)
+			g->vhd_cols = 1;
+		break;
+	default:
+		break;
+	}
+}
+
+static void put_footer(struct gen *g, const char *name)
+{
+	char line[128];
+
+	switch (g->format) {
+	case F_MIF:
+		put_str("END;\n");
+		break;
+	case F_VHD:
+		if (g->addr % g->vhd_cols)
+			put_str("\n");
+		snprintf(line, sizeof(line), "\nend package %s_pkg;\n", name);
+		put_str(line);
+		break;
+	default:
+		break;
+	}
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s [-f bram|mif|vhd|write|bin] [-w width] [-d depth] [-p pad]\n"
+		"       %*s [-i] [-n name] [-o output] in_file\n"
+		"\n"
+		"  -f, --oformat  output format (default is bram); -of is accepted\n"
+		"  -w, --width    width of memory in bytes (default is 4)\n"
+		"  -d, --depth    depth of memory in words (default is the size of\n"
+		"                 the input file)\n"
+		"  -p, --pad      byte padding value (default is 0)\n"
+		"  -i, --invert   input words are little endian\n"
+		"  -n, --name     name of the VHDL constant (default is mem_init)\n"
+		"  -o, --output   output file (default is stdout)\n"
+		"  in_file        raw binary input, - for stdin\n",
+		prog, (int)strlen(prog), "");
+	exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+	static const struct option opts[] = {
+		{ "oformat", required_argument, NULL, 'f' },
+		{ "width", required_argument, NULL, 'w' },
+		{ "depth", required_argument, NULL, 'd' },
+		{ "pad", required_argument, NULL, 'p' },
+		{ "invert", no_argument, NULL, 'i' },
+		{ "name", required_argument, NULL, 'n' },
+		{ "output", required_argument, NULL, 'o' },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 }
+	};
+	struct gen g = { .format = F_BRAM, .width = 4 };
+	const char *in_name, *out_name = NULL;
+	char name[128] = "mem_init";
+	unsigned long long depth = 0, in_words = 0, n;
+	static uint8_t in_buf[IN_BLOCK + MAX_WIDTH];
+	uint8_t word[MAX_WIDTH];
+	int invert = 0, pad = 0, c, i, j;
+	size_t len, fill = 0, chunk;
+	struct stat st;
+	FILE *in;
+
+	/* mem_init_gen.py compatibility */
+	for (i = 1; i < argc; i++)
+		if (!strcmp(argv[i], "-of"))
+			argv[i] = "--oformat";
+
+	while ((c = getopt_long(argc, argv, "f:w:d:p:in:o:h", opts, NULL)) != -1) {
+		switch (c) {
+		case 'f':
+			for (i = 0; i < 5; i++)
+				if (!strcasecmp(optarg, format_names[i]))
+					break;
+			if (i == 5)
+				usage(argv[0]);
+			g.format = i;
+			break;
+		case 'w':
+			g.width = atoi(optarg);
+			break;
+		case 'd':
+			depth = strtoull(optarg, NULL, 0);
+			break;
+		case 'p':
+			pad = strtol(optarg, NULL, 0);
+			break;
+		case 'i':
+			invert = 1;
+			break;
+		case 'n':
+			snprintf(name, sizeof(name), "%s", optarg);
+			for (i = 0; name[i]; i++)
+				if (name[i] >= 'A' && name[i] <= 'Z')
+					name[i] += 'a' - 'A';
+			break;
+		case 'o':
+			out_name = optarg;
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (optind != argc - 1)
+		usage(argv[0]);
+	if (g.width < 1 || g.width > MAX_WIDTH) {
+		fprintf(stderr, "Width must be between 1 and %d\n", MAX_WIDTH);
+		return 2;
+	}
+	if (pad < 0 || pad > 255) {
+		fprintf(stderr, "Padding value must be between 0 and 255\n");
+		return 2;
+	}
+
+	in_name = argv[optind];
+	in = strcmp(in_name, "-") ? fopen(in_name, "rb") : stdin;
+	if (!in) {
+		perror(in_name);
+		return 1;
+	}
+	setvbuf(in, NULL, _IONBF, 0);
+
+	if (depth) {
+		g.words = depth;
+	} else if (!fstat(fileno(in), &st) && S_ISREG(st.st_mode)) {
+		g.words = (st.st_size + g.width - 1) / g.width;
+	} else if (g.format == F_MIF || g.format == F_VHD) {
+		fprintf(stderr, "%s: -d is needed for %s from a stream\n",
+			in_name, format_names[g.format]);
+		return 2;
+	}
+
+	if (!g.words && (g.format == F_MIF || g.format == F_VHD)) {
+		fprintf(stderr, "%s: empty input\n", in_name);
+		return 2;
+	}
+
+	out = out_name ? fopen(out_name, "wb") : stdout;
+	if (!out) {
+		perror(out_name);
+		return 1;
+	}
+	setvbuf(out, NULL, _IONBF, 0);
+
+	init_luts();
+	put_header(&g, in_name, name, argc, argv);
+
+	/* whole words per block, the partial word is carried to the next one */
+	chunk = IN_BLOCK - IN_BLOCK % g.width;
+	for (;;) {
+		if (depth && in_words >= depth)
+			break;
+		len = fread(in_buf + fill, 1, chunk - fill, in);
+		fill += len;
+		if (fill < chunk && ferror(in)) {
+			perror(in_name);
+			return 1;
+		}
+		n = fill / g.width;
+		if (depth && in_words + n > depth)
+			n = depth - in_words;
+		for (i = 0; i < (int)n; i++) {
+			const uint8_t *src = in_buf + (size_t)i * g.width;
+
+			if (invert) {
+				for (j = 0; j < g.width; j++)
+					word[j] = src[g.width - 1 - j];
+				put_word(&g, word);
+			} else {
+				put_word(&g, src);
+			}
+		}
+		in_words += n;
+		if (depth && in_words >= depth) {
+			fill = 0;
+			break;
+		}
+		memmove(in_buf, in_buf + n * g.width, fill - n * g.width);
+		fill -= n * g.width;
+		if (!len)
+			break;
+	}
+
+	/* last partial word */
+	if (fill) {
+		memset(in_buf + fill, pad, g.width - fill);
+		if (invert) {
+			for (j = 0; j < g.width; j++)
+				word[j] = in_buf[g.width - 1 - j];
+			put_word(&g, word);
+		} else {
+			put_word(&g, in_buf);
+		}
+		in_words++;
+	}
+
+	/* pad up to depth */
+	memset(word, pad, g.width);
+	if (!depth)
+		g.words = in_words;
+	while (g.addr < g.words)
+		put_word(&g, word);
+
+	put_footer(&g, name);
+	flush_out();
+	if (in != stdin)
+		fclose(in);
+	if (out != stdout && fclose(out)) {
+		perror(out_name);
+		return 1;
+	}
+
+	return 0;
+}